@@ -0,0 +1,142 @@
+#include "BatchRenderer.h"
+#include "../Core/AudioClip.h"
+#include "../Core/Adapters/Wav.h"
+#include "../Core/Constants.h"
+#include "../Core/Logging/ConsoleLogger.h"
+#include "../Core/Services/PcmCache.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+// Prefixes messages with the file being processed; INFO lines only in verbose mode.
+class JobLogger : public ILogger {
+public:
+    JobLogger(std::string prefix, bool verbose, std::mutex& mutex)
+        : prefix_(std::move(prefix)), verbose_(verbose), mutex_(mutex) {}
+
+    void log(const std::string& message) override {
+        if (!verbose_) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        console_.log(prefix_ + message);
+    }
+
+    void error(const std::string& message) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        console_.error(prefix_ + message);
+    }
+
+    void warning(const std::string& message) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        console_.warning(prefix_ + message);
+    }
+
+private:
+    std::string prefix_;
+    bool verbose_;
+    std::mutex& mutex_;
+    ConsoleLogger console_;
+};
+
+}
+
+BatchRenderer::BatchRenderer(EffectChainSpec chain, Options options)
+    : chain_(std::move(chain))
+    , options_(std::move(options))
+    , budget_(options_.memoryBudgetBytes)
+{
+}
+
+std::string BatchRenderer::outputPathFor(const std::string& input) const {
+    const std::filesystem::path source(input);
+    const std::string name = source.stem().string() + options_.suffix + ".mp3";
+    return (std::filesystem::path(options_.outputDir) / name).string();
+}
+
+size_t BatchRenderer::estimateBytes(const std::string& input) {
+    std::error_code ec;
+    const auto fileSize = std::filesystem::file_size(input, ec);
+    if (ec) return 0;
+    
+    const size_t expansion = WavAdapter::isWavFile(input)
+        ? audio::batch::kDecodedBytesPerWavByte : audio::batch::kDecodedBytesPerEncodedByte;
+    return static_cast<size_t>(fileSize) * expansion * audio::batch::kWorkingCopies;
+}
+
+bool BatchRenderer::renderFile(const std::string& input, const std::string& output) {
+    auto logger = std::make_shared<JobLogger>(input + ": ", options_.verbose, reportMutex_);
+    
+    // Files already run in parallel; split the remaining cores between them.
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    
+    AudioClip clip(input, logger);
+    clip.setDecodeThreads(std::max(1u, cores / std::max(1u, options_.jobs)));
+    clip.setEncodeThreads(options_.encodeThreads);
+    clip.setPcmCache(options_.pcmCache);
+    if (!clip.load()) {
+        return false;
+    }
+    
+    std::vector<float>& samples = clip.getSamplesRef();
+    for (const auto& effect : chain_.createChain(logger)) {
+        effect->apply(samples);
+    }
+    
+    return clip.save(output);
+}
+
+void BatchRenderer::report(const std::string& line) {
+    std::lock_guard<std::mutex> lock(reportMutex_);
+    std::cout << line << std::endl;
+}
+
+size_t BatchRenderer::run(const std::vector<std::string>& inputs) {
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> finished{0};
+    std::atomic<size_t> failures{0};
+    
+    auto worker = [&]() {
+        for (size_t index = next++; index < inputs.size(); index = next++) {
+            const std::string& input = inputs[index];
+            const std::string output = outputPathFor(input);
+            const size_t reserved = estimateBytes(input);
+            
+            budget_.acquire(reserved);
+            const auto start = std::chrono::steady_clock::now();
+            const bool ok = renderFile(input, output);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            budget_.release(reserved);
+            
+            if (!ok) ++failures;
+            
+            std::ostringstream line;
+            line << "[" << ++finished << "/" << inputs.size() << "] "
+                 << (ok ? "ok     " : "FAILED ") << input;
+            if (ok) {
+                line << " -> " << output;
+            }
+            line << " (" << std::fixed << std::setprecision(2) << elapsed.count() << " s)";
+            report(line.str());
+        }
+    };
+    
+    const unsigned threadCount = static_cast<unsigned>(
+        std::max<size_t>(1, std::min<size_t>(options_.jobs, inputs.size())));
+    
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    return failures;
+}
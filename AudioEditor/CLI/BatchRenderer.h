@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "EffectChainSpec.h"
+#include "MemoryBudget.h"
+
+class PcmCache;
+
+// Applies one effect chain to many files on a pool of worker threads. Each
+// worker reserves an estimate of the file's decoded footprint from a shared
+// budget before loading it.
+class BatchRenderer {
+public:
+    struct Options {
+        std::string outputDir;
+        std::string suffix;
+        unsigned jobs = 1;
+        unsigned encodeThreads = 1;
+        size_t memoryBudgetBytes = 0;
+        bool verbose = false;
+        // Shared by all workers; null disables caching.
+        std::shared_ptr<PcmCache> pcmCache;
+    };
+
+    BatchRenderer(EffectChainSpec chain, Options options);
+
+    BatchRenderer(const BatchRenderer&) = delete;
+    BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+    // Returns the number of files that failed.
+    [[nodiscard]] size_t run(const std::vector<std::string>& inputs);
+
+    [[nodiscard]] std::string outputPathFor(const std::string& input) const;
+
+private:
+    [[nodiscard]] bool renderFile(const std::string& input, const std::string& output);
+    [[nodiscard]] static size_t estimateBytes(const std::string& input);
+    void report(const std::string& line);
+
+    EffectChainSpec chain_;
+    Options options_;
+    MemoryBudget budget_;
+    std::mutex reportMutex_;
+};
@@ -0,0 +1,99 @@
+#include "EffectChainSpec.h"
+#include "../Core/EffectFactory.h"
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+std::string trim(const std::string& text) {
+    const auto first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return {};
+    const auto last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+}
+
+bool EffectChainSpec::addEntry(const std::string& text, std::string& error) {
+    const auto colon = text.find(':');
+    Entry entry;
+    entry.type = trim(text.substr(0, colon));
+    
+    auto effect = EffectFactory::createEffect(entry.type, nullptr);
+    if (!effect) {
+        error = "unknown effect '" + entry.type + "'";
+        return false;
+    }
+    const auto accepted = effect->getParameters();
+    
+    if (colon != std::string::npos) {
+        std::stringstream list(text.substr(colon + 1));
+        std::string assignment;
+        
+        while (std::getline(list, assignment, ',')) {
+            const auto equals = assignment.find('=');
+            if (equals == std::string::npos) {
+                error = entry.type + ": expected name=value, got '" + trim(assignment) + "'";
+                return false;
+            }
+            
+            const std::string name = trim(assignment.substr(0, equals));
+            const std::string value = trim(assignment.substr(equals + 1));
+            
+            if (accepted.find(name) == accepted.end()) {
+                error = entry.type + ": unknown parameter '" + name + "'";
+                return false;
+            }
+            
+            try {
+                size_t used = 0;
+                entry.parameters[name] = std::stof(value, &used);
+                if (used != value.size()) throw std::invalid_argument(value);
+            } catch (const std::exception&) {
+                error = entry.type + ": '" + value + "' is not a number";
+                return false;
+            }
+        }
+    }
+    
+    entries_.push_back(std::move(entry));
+    return true;
+}
+
+bool EffectChainSpec::addPreset(const std::string& filePath, std::string& error) {
+    std::ifstream file(filePath);
+    if (!file) {
+        error = "cannot open preset " + filePath;
+        return false;
+    }
+    
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        
+        if (!addEntry(line, error)) {
+            error = filePath + ":" + std::to_string(lineNumber) + ": " + error;
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+std::vector<std::shared_ptr<IEffect>> EffectChainSpec::createChain(std::shared_ptr<ILogger> logger) const {
+    std::vector<std::shared_ptr<IEffect>> chain;
+    chain.reserve(entries_.size());
+    
+    for (const auto& entry : entries_) {
+        auto effect = EffectFactory::createEffect(entry.type, logger);
+        for (const auto& [name, value] : entry.parameters) {
+            effect->setParameter(name, value);
+        }
+        chain.push_back(std::move(effect));
+    }
+    
+    return chain;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../Core/Effects/IEffect.h"
+#include "../Core/Logging/ILogger.h"
+
+// An effect chain as written on the command line or in a preset file.
+// Each entry is "Type" or "Type:name=value,name=value", e.g. "Speed:speed=1.25".
+// Preset files hold one entry per line; blank lines and '#' comments are skipped.
+class EffectChainSpec {
+public:
+    struct Entry {
+        std::string type;
+        std::map<std::string, float> parameters;
+    };
+
+    // Both return false and fill error on a malformed entry, an unregistered
+    // effect type or a parameter the effect does not accept.
+    [[nodiscard]] bool addEntry(const std::string& text, std::string& error);
+    [[nodiscard]] bool addPreset(const std::string& filePath, std::string& error);
+
+    // Fresh effect instances; effects carry state, so every job needs its own.
+    [[nodiscard]] std::vector<std::shared_ptr<IEffect>> createChain(std::shared_ptr<ILogger> logger) const;
+
+    [[nodiscard]] const std::vector<Entry>& entries() const noexcept { return entries_; }
+    [[nodiscard]] bool empty() const noexcept { return entries_.empty(); }
+
+private:
+    std::vector<Entry> entries_;
+};
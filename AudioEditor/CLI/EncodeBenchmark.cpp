@@ -0,0 +1,171 @@
+#include "EncodeBenchmark.h"
+#include "../Core/Adapters/Mp3.h"
+#include "../Core/Adapters/Mp3Encoder.h"
+#include "../Core/Adapters/ParallelMp3Encoder.h"
+#include "../Core/Adapters/Wav.h"
+#include "../Core/Constants.h"
+#include "../Core/Logging/ConsoleLogger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+struct Fidelity {
+    double snrDb = 0.0;
+    size_t lag = 0;
+};
+
+// Aligns decoded with source (the decoder output is delayed by the encoder and
+// decoder latency) on a one second window, then measures SNR over the overlap.
+Fidelity measureFidelity(const SampleBuffer& source, const SampleBuffer& decoded,
+                         int channels, int sampleRate, size_t maxLag) {
+    const size_t ch = static_cast<size_t>(channels);
+    const size_t frames = std::min(source.size(), decoded.size()) / ch;
+    Fidelity result;
+    if (frames <= maxLag) return result;
+    
+    const size_t window = std::min(static_cast<size_t>(sampleRate), frames - maxLag);
+    const size_t windowStart = (frames - maxLag - window) / 2;
+    double bestScore = -1.0;
+    
+    for (size_t lag = 0; lag <= maxLag; ++lag) {
+        double cross = 0.0;
+        double energy = 0.0;
+        for (size_t i = windowStart; i < windowStart + window; ++i) {
+            const double d = decoded[(i + lag) * ch];
+            cross += source[i * ch] * d;
+            energy += d * d;
+        }
+        const double score = energy > 0.0 ? cross / std::sqrt(energy) : 0.0;
+        if (score > bestScore) {
+            bestScore = score;
+            result.lag = lag;
+        }
+    }
+    
+    double signal = 0.0;
+    double noise = 0.0;
+    const size_t overlap = std::min(source.size(), decoded.size() - result.lag * ch);
+    for (size_t i = 0; i < overlap; ++i) {
+        const double s = source[i];
+        const double e = s - decoded[i + result.lag * ch];
+        signal += s * s;
+        noise += e * e;
+    }
+    result.snrDb = noise > 0.0 ? 10.0 * std::log10(signal / noise) : 200.0;
+    return result;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+EncodeBenchmark::EncodeBenchmark(EffectChainSpec chain, Options options)
+    : chain_(std::move(chain))
+    , options_(std::move(options))
+{
+}
+
+size_t EncodeBenchmark::run(const std::vector<std::string>& inputs) {
+    size_t failures = 0;
+    for (const auto& input : inputs) {
+        if (!benchmarkFile(input)) ++failures;
+    }
+    return failures;
+}
+
+bool EncodeBenchmark::benchmarkFile(const std::string& input) {
+    std::shared_ptr<ILogger> logger;
+    if (options_.verbose) {
+        logger = std::make_shared<ConsoleLogger>();
+    }
+    
+    std::unique_ptr<AudioFileAdapter> source;
+    if (WavAdapter::isWavFile(input)) {
+        source = std::make_unique<WavAdapter>(logger);
+    } else {
+        source = std::make_unique<Mp3Adapter>(logger);
+    }
+    
+    if (!source->load(input)) {
+        std::cout << "FAILED " << input << ": cannot decode" << std::endl;
+        return false;
+    }
+    
+    const int sampleRate = source->getSampleRate();
+    const int channels = source->getChannels();
+    SampleBuffer rendered = source->takeSamples();
+    std::vector<float>& samples = rendered.mutableSamples();
+    for (const auto& effect : chain_.createChain(logger)) {
+        effect->apply(samples);
+    }
+    
+    const std::filesystem::path dir(options_.outputDir);
+    const std::string stem = std::filesystem::path(input).stem().string();
+    const std::string serialPath = (dir / (stem + ".serial.mp3")).string();
+    const std::string parallelPath = (dir / (stem + ".parallel.mp3")).string();
+    
+    auto start = std::chrono::steady_clock::now();
+    Mp3Encoder serial(logger);
+    if (!serial.open(serialPath, sampleRate, channels) ||
+        !serial.write(samples.data(), samples.size()) || !serial.finish()) {
+        std::cout << "FAILED " << input << ": serial encode" << std::endl;
+        return false;
+    }
+    const double serialSeconds = secondsSince(start);
+    
+    const size_t segments = ParallelMp3Encoder::segmentCount(samples.size() / channels, options_.threads);
+    start = std::chrono::steady_clock::now();
+    ParallelMp3Encoder parallel(logger);
+    if (!parallel.encode(parallelPath, samples.data(), samples.size(),
+                         sampleRate, channels, options_.threads)) {
+        std::cout << "FAILED " << input << ": parallel encode" << std::endl;
+        return false;
+    }
+    const double parallelSeconds = secondsSince(start);
+    
+    Mp3Adapter serialDecoded(logger);
+    Mp3Adapter parallelDecoded(logger);
+    if (!serialDecoded.load(serialPath) || !parallelDecoded.load(parallelPath)) {
+        std::cout << "FAILED " << input << ": cannot decode encoded output" << std::endl;
+        return false;
+    }
+    
+    Mp3Encoder probe(nullptr);
+    const size_t spf = probe.openInMemory(sampleRate, channels)
+        ? static_cast<size_t>(probe.frameSize()) : 1152;
+    const size_t maxLag = audio::batch::kEncodeBenchmarkMaxLagMpegFrames * spf;
+    
+    const Fidelity serialFidelity = measureFidelity(
+        rendered, serialDecoded.getSamples(), channels, sampleRate, maxLag);
+    const Fidelity parallelFidelity = measureFidelity(
+        rendered, parallelDecoded.getSamples(), channels, sampleRate, maxLag);
+    
+    const size_t serialFrames = serialDecoded.getSamples().size() / channels;
+    const size_t parallelFrames = parallelDecoded.getSamples().size() / channels;
+    const size_t lengthDifference = serialFrames > parallelFrames
+        ? serialFrames - parallelFrames : parallelFrames - serialFrames;
+    
+    const bool pass = lengthDifference <= spf && parallelFidelity.lag == serialFidelity.lag &&
+        parallelFidelity.snrDb >= serialFidelity.snrDb - audio::batch::kEncodeBenchmarkMaxSnrLossDb;
+    
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2)
+         << (pass ? "PASS   " : "FAILED ") << input << "\n"
+         << "  serial:   " << serialSeconds << " s, SNR " << serialFidelity.snrDb
+         << " dB, " << serialFrames << " frames, lag " << serialFidelity.lag << "\n"
+         << "  parallel: " << parallelSeconds << " s, SNR " << parallelFidelity.snrDb
+         << " dB, " << parallelFrames << " frames, lag " << parallelFidelity.lag
+         << ", " << segments << " segments\n"
+         << "  speed-up: " << (parallelSeconds > 0.0 ? serialSeconds / parallelSeconds : 0.0) << "x";
+    std::cout << line.str() << std::endl;
+    
+    return pass;
+}
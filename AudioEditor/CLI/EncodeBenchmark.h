@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "EffectChainSpec.h"
+
+// Encodes every input both serially and as parallel segments, decodes the two
+// results and reports the speed-up and how closely each tracks the source.
+// Files are processed one at a time so the timings are not disturbed.
+class EncodeBenchmark {
+public:
+    struct Options {
+        std::string outputDir;
+        unsigned threads = 1;
+        bool verbose = false;
+    };
+
+    EncodeBenchmark(EffectChainSpec chain, Options options);
+
+    // Returns the number of files that failed or fell outside the tolerance.
+    [[nodiscard]] size_t run(const std::vector<std::string>& inputs);
+
+private:
+    [[nodiscard]] bool benchmarkFile(const std::string& input);
+
+    EffectChainSpec chain_;
+    Options options_;
+};
@@ -0,0 +1,22 @@
+#include "MemoryBudget.h"
+
+MemoryBudget::MemoryBudget(size_t totalBytes)
+    : totalBytes_(totalBytes)
+{
+}
+
+void MemoryBudget::acquire(size_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_.wait(lock, [&] {
+        return usedBytes_ == 0 || usedBytes_ + bytes <= totalBytes_;
+    });
+    usedBytes_ += bytes;
+}
+
+void MemoryBudget::release(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        usedBytes_ -= bytes;
+    }
+    available_.notify_all();
+}
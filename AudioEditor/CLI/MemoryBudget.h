@@ -0,0 +1,24 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+// Counting limit on bytes held by concurrent jobs. A job larger than the whole
+// budget is still admitted once nothing else is running.
+class MemoryBudget {
+public:
+    explicit MemoryBudget(size_t totalBytes);
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    void acquire(size_t bytes);
+    void release(size_t bytes);
+
+private:
+    std::mutex mutex_;
+    std::condition_variable available_;
+    size_t totalBytes_;
+    size_t usedBytes_ = 0;
+};
@@ -0,0 +1,203 @@
+#include <mpg123.h>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BatchRenderer.h"
+#include "EncodeBenchmark.h"
+#include "EffectChainSpec.h"
+#include "../Core/Constants.h"
+#include "../Core/Effects/BuiltinEffects.h"
+#include "../Core/Services/PcmCache.h"
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout
+        << "Usage: " << program << " [options] -o DIR FILE...\n"
+        << "\n"
+        << "Applies an effect chain to every input file and writes the results to DIR.\n"
+        << "\n"
+        << "Options:\n"
+        << "  -e, --effect SPEC     Append an effect, e.g. Reverb:intensity=0.6\n"
+        << "  -p, --preset FILE     Append the effects listed in FILE, one SPEC per line\n"
+        << "  -o, --output DIR      Output directory (created if missing)\n"
+        << "  -l, --list FILE       Read input paths from FILE, one per line\n"
+        << "  -j, --jobs N          Files processed in parallel (default: hardware threads)\n"
+        << "  -m, --memory-mb N     Memory budget for decoded audio (default: "
+        << audio::batch::kDefaultMemoryBudgetMb << ")\n"
+        << "      --suffix TEXT     Appended to each output file name\n"
+        << "      --encode-threads N  Encode long files as N parallel segments (default: 1)\n"
+        << "      --pcm-cache-mb N  Cache decoded MP3 audio on disk, up to N MB (default: $"
+        << audio::cache::kPcmCacheSizeVariable << " or off)\n"
+        << "      --benchmark-encode  Compare serial and parallel encoding of each file\n"
+        << "  -v, --verbose         Log progress of every stage\n"
+        << "  -h, --help            Show this help\n";
+}
+
+bool readList(const std::string& path, std::vector<std::string>& inputs) {
+    std::ifstream file(path);
+    if (!file) return false;
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        inputs.push_back(line);
+    }
+    return true;
+}
+
+bool parseCount(const std::string& text, size_t& value) {
+    try {
+        size_t consumed = 0;
+        const unsigned long long parsed = std::stoull(text, &consumed);
+        if (consumed != text.size() || parsed == 0) return false;
+        value = static_cast<size_t>(parsed);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    EffectChainSpec chain;
+    BatchRenderer::Options options;
+    options.jobs = std::max(1u, std::thread::hardware_concurrency());
+    size_t memoryMb = audio::batch::kDefaultMemoryBudgetMb;
+    uint64_t pcmCacheBytes = PcmCache::configuredCapacity();
+    bool benchmarkEncode = false;
+    std::vector<std::string> inputs;
+    
+    registerBuiltinEffects();
+    
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&](std::string& out) {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+            out = argv[++i];
+            return true;
+        };
+        
+        std::string text;
+        std::string error;
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "-v" || arg == "--verbose") {
+            options.verbose = true;
+        } else if (arg == "-e" || arg == "--effect") {
+            if (!value(text)) return 2;
+            if (!chain.addEntry(text, error)) {
+                std::cerr << error << std::endl;
+                return 2;
+            }
+        } else if (arg == "-p" || arg == "--preset") {
+            if (!value(text)) return 2;
+            if (!chain.addPreset(text, error)) {
+                std::cerr << error << std::endl;
+                return 2;
+            }
+        } else if (arg == "-o" || arg == "--output") {
+            if (!value(options.outputDir)) return 2;
+        } else if (arg == "-l" || arg == "--list") {
+            if (!value(text)) return 2;
+            if (!readList(text, inputs)) {
+                std::cerr << "Cannot read input list: " << text << std::endl;
+                return 2;
+            }
+        } else if (arg == "-j" || arg == "--jobs") {
+            size_t jobs = 0;
+            if (!value(text)) return 2;
+            if (!parseCount(text, jobs)) {
+                std::cerr << "Invalid job count: " << text << std::endl;
+                return 2;
+            }
+            options.jobs = static_cast<unsigned>(jobs);
+        } else if (arg == "-m" || arg == "--memory-mb") {
+            if (!value(text)) return 2;
+            if (!parseCount(text, memoryMb)) {
+                std::cerr << "Invalid memory budget: " << text << std::endl;
+                return 2;
+            }
+        } else if (arg == "--encode-threads") {
+            size_t threads = 0;
+            if (!value(text)) return 2;
+            if (!parseCount(text, threads)) {
+                std::cerr << "Invalid encode thread count: " << text << std::endl;
+                return 2;
+            }
+            options.encodeThreads = static_cast<unsigned>(threads);
+        } else if (arg == "--pcm-cache-mb") {
+            size_t cacheMb = 0;
+            if (!value(text)) return 2;
+            if (!parseCount(text, cacheMb)) {
+                std::cerr << "Invalid PCM cache size: " << text << std::endl;
+                return 2;
+            }
+            pcmCacheBytes = static_cast<uint64_t>(cacheMb) * 1024 * 1024;
+        } else if (arg == "--benchmark-encode") {
+            benchmarkEncode = true;
+        } else if (arg == "--suffix") {
+            if (!value(options.suffix)) return 2;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 2;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    
+    if (options.outputDir.empty() || inputs.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    
+    std::error_code ec;
+    std::filesystem::create_directories(options.outputDir, ec);
+    if (ec) {
+        std::cerr << "Cannot create output directory " << options.outputDir
+                  << ": " << ec.message() << std::endl;
+        return 2;
+    }
+    
+    options.memoryBudgetBytes = memoryMb * 1024 * 1024;
+    if (pcmCacheBytes > 0) {
+        options.pcmCache = std::make_shared<PcmCache>(nullptr, pcmCacheBytes);
+    }
+    
+    mpg123_init();
+    
+    size_t failures = 0;
+    if (benchmarkEncode) {
+        EncodeBenchmark::Options benchmarkOptions;
+        benchmarkOptions.outputDir = options.outputDir;
+        benchmarkOptions.threads = options.encodeThreads > 1
+            ? options.encodeThreads : std::max(1u, std::thread::hardware_concurrency());
+        benchmarkOptions.verbose = options.verbose;
+        
+        EncodeBenchmark benchmark(std::move(chain), benchmarkOptions);
+        failures = benchmark.run(inputs);
+    } else {
+        BatchRenderer renderer(std::move(chain), options);
+        failures = renderer.run(inputs);
+    }
+    
+    mpg123_exit();
+    
+    if (failures > 0) {
+        std::cerr << failures << " of " << inputs.size() << " files failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,23 +1,52 @@
 #pragma once
 
+#include <functional>
 #include <vector>
 #include <string>
-
+#include <memory>
+#include "AudioStreamReader.h"
+#include "../SampleBuffer.h"
 
 class AudioFileAdapter {
 public:
+    // Receives decoded frames from the start of the file onwards; returning
+    // false abandons the load.
+    using DecodeCallback = std::function<bool(const float* samples, size_t frames)>;
+
     virtual ~AudioFileAdapter() = default;
 
     [[nodiscard]] virtual bool load(const std::string& filePath) = 0;
  
     [[nodiscard]] virtual bool save(const std::string& filePath, 
-                                    const std::vector<float>& samples) = 0;
+                                    const SampleBuffer& samples) = 0;
+
+    // Incremental access that does not go through load(); returns nullptr
+    // when the file cannot be opened.
+    [[nodiscard]] virtual std::unique_ptr<AudioStreamReader> openReader(
+        const std::string& filePath) const = 0;
+
+    [[nodiscard]] virtual const SampleBuffer& getSamples() const = 0;
 
-    [[nodiscard]] virtual const std::vector<float>& getSamples() const = 0;
+    // Hands the decoded samples over without a copy; getSamples() is empty afterwards.
+    [[nodiscard]] virtual SampleBuffer takeSamples() = 0;
 
     [[nodiscard]] virtual float getDuration() const noexcept = 0;
 
     [[nodiscard]] virtual int getSampleRate() const noexcept = 0;
 
     [[nodiscard]] virtual int getChannels() const noexcept = 0;
+
+    // Format used by save() when nothing was loaded through this adapter.
+    virtual void setFormat(int sampleRate, int channels) = 0;
+
+    // Upper bound on threads load() may use; 0 picks one per core.
+    virtual void setDecodeThreads(unsigned threads) { (void)threads; }
+
+    // Adapters that decode call it from load() as each stretch of frames
+    // becomes final, in file order; files loaded in place never do.
+    virtual void setDecodeCallback(DecodeCallback callback) { (void)callback; }
+
+    // Threads save() may encode with; 0 picks one per core. Encoders that
+    // trade quality for parallelism default to 1.
+    virtual void setEncodeThreads(unsigned threads) { (void)threads; }
 };
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Sequential, seekable access to a file's interleaved float frames, for
+// consumers that want to start on the first blocks before the rest of the
+// file has been decoded.
+class AudioStreamReader {
+public:
+    virtual ~AudioStreamReader() = default;
+
+    [[nodiscard]] virtual int getSampleRate() const noexcept = 0;
+    [[nodiscard]] virtual int getChannels() const noexcept = 0;
+
+    // Length in frames. Compressed formats without a length header may only
+    // estimate it; the value becomes exact once read() reaches the end.
+    [[nodiscard]] virtual size_t totalFrames() const noexcept = 0;
+
+    [[nodiscard]] virtual size_t position() const noexcept = 0;
+
+    // Reads up to frames frames into buffer (frames * getChannels() floats)
+    // and returns how many were read; 0 at the end of the stream.
+    [[nodiscard]] virtual size_t read(float* buffer, size_t frames) = 0;
+
+    // Moves to an absolute frame. Returns false if it cannot be reached.
+    [[nodiscard]] virtual bool seek(size_t frame) = 0;
+
+    // Why read() last stopped short of the end of the stream; empty when it
+    // simply reached the end.
+    [[nodiscard]] virtual std::string error() const { return {}; }
+};
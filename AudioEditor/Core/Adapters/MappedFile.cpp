@@ -0,0 +1,48 @@
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string& filePath, std::string& error) {
+    const int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = std::strerror(errno);
+        return nullptr;
+    }
+    
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        error = std::strerror(errno);
+        ::close(fd);
+        return nullptr;
+    }
+    if (info.st_size <= 0) {
+        error = "empty file";
+        ::close(fd);
+        return nullptr;
+    }
+    
+    const size_t size = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+    
+    if (data == MAP_FAILED) {
+        error = std::strerror(errno);
+        return nullptr;
+    }
+    
+    return std::shared_ptr<const MappedFile>(
+        new MappedFile(static_cast<const unsigned char*>(data), size));
+}
+
+MappedFile::~MappedFile() {
+    munmap(const_cast<unsigned char*>(data_), size_);
+}
+
+void MappedFile::adviseSequential() const noexcept {
+    madvise(const_cast<unsigned char*>(data_), size_, MADV_SEQUENTIAL);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages come from the page cache on
+// first touch, so opening is cheap regardless of the file size.
+class MappedFile {
+public:
+    // Returns nullptr and fills error when the file cannot be opened or mapped.
+    [[nodiscard]] static std::shared_ptr<const MappedFile> open(const std::string& filePath,
+                                                                std::string& error);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] const unsigned char* data() const noexcept { return data_; }
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+
+    // Hints the kernel to read ahead aggressively for one front-to-back pass.
+    void adviseSequential() const noexcept;
+
+private:
+    MappedFile(const unsigned char* data, size_t size) : data_(data), size_(size) {}
+
+    const unsigned char* data_;
+    size_t size_;
+};
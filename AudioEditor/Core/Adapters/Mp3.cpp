@@ -1,8 +1,201 @@
 #include "Mp3.h"
+#include "Mp3Encoder.h"
+#include "ParallelMp3Encoder.h"
 #include <mpg123.h>
-#include <lame/lame.h>
+#include "../Dsp/SampleKernels.h"
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct DecoderDeleter {
+    void operator()(mpg123_handle* mh) const {
+        mpg123_close(mh);
+        mpg123_delete(mh);
+    }
+};
+
+using DecoderHandle = std::unique_ptr<mpg123_handle, DecoderDeleter>;
+
+struct FrameIndex {
+    std::vector<off_t> offsets;
+    off_t step = 0;
+};
+
+// Limits the decoder to one output encoding at every rate. Must run before
+// mpg123_open: the output format is negotiated when the stream is opened.
+// False when this decoder build cannot produce the encoding.
+bool restrictEncoding(mpg123_handle* mh, int encoding) {
+    const long* rates = nullptr;
+    size_t count = 0;
+    mpg123_rates(&rates, &count);
+    if (count == 0 || mpg123_format_none(mh) != MPG123_OK) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        mpg123_format(mh, rates[i], MPG123_MONO | MPG123_STEREO, encoding);
+    }
+    return mpg123_format_support(mh, rates[0], encoding) != 0;
+}
+
+// Reads up to count interleaved samples into dst and returns how many arrived.
+// result holds the last mpg123_read() status.
+size_t readSamples(mpg123_handle* mh, float* dst, size_t count, bool floatOutput,
+                   std::vector<int16_t>& pcm, int& result) {
+    size_t filled = 0;
+    size_t done = 0;
+    result = MPG123_OK;
+    
+    while (filled < count && result == MPG123_OK) {
+        if (floatOutput) {
+            result = mpg123_read(mh, reinterpret_cast<unsigned char*>(dst + filled),
+                                 (count - filled) * sizeof(float), &done);
+            filled += done / sizeof(float);
+        } else {
+            const size_t wanted = std::min(count - filled, pcm.size());
+            result = mpg123_read(mh, reinterpret_cast<unsigned char*>(pcm.data()),
+                                 wanted * sizeof(int16_t), &done);
+            dsp::int16ToFloat(pcm.data(), dst + filled, done / sizeof(int16_t));
+            filled += done / sizeof(int16_t);
+        }
+    }
+    
+    return filled;
+}
+
+class Mp3StreamReader : public AudioStreamReader {
+public:
+    // Asks for float output, falling back to converted 16-bit when the
+    // decoder build has no float support.
+    [[nodiscard]] bool open(const std::string& filePath, std::string& error) {
+        mh_.reset(mpg123_new(nullptr, nullptr));
+        if (!mh_) {
+            error = "failed to create mpg123 handle";
+            return false;
+        }
+        
+        if (!restrictEncoding(mh_.get(), MPG123_ENC_FLOAT_32)) {
+            restrictEncoding(mh_.get(), MPG123_ENC_SIGNED_16);
+        }
+        
+        if (mpg123_open(mh_.get(), filePath.c_str()) != MPG123_OK) {
+            error = mpg123_strerror(mh_.get());
+            mh_.reset();
+            return false;
+        }
+        
+        int encoding = 0;
+        if (mpg123_getformat(mh_.get(), &rate_, &channels_, &encoding) != MPG123_OK) {
+            error = mpg123_strerror(mh_.get());
+            return false;
+        }
+        
+        if (encoding != MPG123_ENC_FLOAT_32 && encoding != MPG123_ENC_SIGNED_16) {
+            error = "unsupported output encoding " + std::to_string(encoding);
+            return false;
+        }
+        
+        floatOutput_ = encoding == MPG123_ENC_FLOAT_32;
+        if (!floatOutput_) {
+            pcm_.resize(audio::kMp3DecodeChunkFrames * static_cast<size_t>(channels_));
+        }
+        
+        const off_t length = mpg123_length(mh_.get());
+        totalFrames_ = length > 0 ? static_cast<size_t>(length) : 0;
+        return true;
+    }
+    
+    // Seeks jump straight to indexed frames instead of walking the stream.
+    void setFrameIndex(const FrameIndex& index) {
+        if (index.offsets.empty()) return;
+        std::vector<off_t> offsets = index.offsets;
+        mpg123_set_index(mh_.get(), offsets.data(), index.step, offsets.size());
+    }
+    
+    [[nodiscard]] int getSampleRate() const noexcept override { return static_cast<int>(rate_); }
+    [[nodiscard]] int getChannels() const noexcept override { return channels_; }
+    [[nodiscard]] size_t totalFrames() const noexcept override { return totalFrames_; }
+    [[nodiscard]] size_t position() const noexcept override { return position_; }
+    
+    [[nodiscard]] size_t read(float* buffer, size_t frames) override {
+        const size_t channels = static_cast<size_t>(channels_);
+        int result = MPG123_OK;
+        const size_t count = readSamples(mh_.get(), buffer, frames * channels,
+                                         floatOutput_, pcm_, result);
+        position_ += count / channels;
+        if (result == MPG123_DONE) {
+            totalFrames_ = position_;
+        } else if (result != MPG123_OK && result != MPG123_NEW_FORMAT) {
+            error_ = mpg123_strerror(mh_.get());
+        }
+        return count / channels;
+    }
+    
+    [[nodiscard]] std::string error() const override { return error_; }
+    
+    [[nodiscard]] bool seek(size_t frame) override {
+        const off_t reached = mpg123_seek(mh_.get(), static_cast<off_t>(frame), SEEK_SET);
+        if (reached < 0) return false;
+        position_ = static_cast<size_t>(reached);
+        return position_ == frame;
+    }
+    
+private:
+    DecoderHandle mh_;
+    long rate_ = 0;
+    int channels_ = 0;
+    bool floatOutput_ = false;
+    size_t totalFrames_ = 0;
+    size_t position_ = 0;
+    std::vector<int16_t> pcm_;
+    std::string error_;
+};
+
+// Decodes frames [start, end) into dst on a private reader. Decoding begins
+// at warmStart so the bit reservoir and filterbank state are rebuilt from
+// earlier frames; those samples are discarded. progress receives the frames
+// of dst decoded so far after every chunk and stops the decode by returning
+// false.
+bool decodeSegment(const std::string& filePath, int channels, const FrameIndex& index,
+                   size_t warmStart, size_t start, size_t end, float* dst,
+                   const std::function<bool(size_t)>& progress) {
+    Mp3StreamReader reader;
+    std::string error;
+    if (!reader.open(filePath, error) || reader.getChannels() != channels) {
+        return false;
+    }
+    
+    reader.setFrameIndex(index);
+    if (!reader.seek(warmStart)) {
+        return false;
+    }
+    
+    std::vector<float> warmup((start - warmStart) * static_cast<size_t>(channels));
+    if (reader.read(warmup.data(), start - warmStart) != start - warmStart) {
+        return false;
+    }
+    
+    const auto stride = static_cast<size_t>(channels);
+    for (size_t done = 0; done < end - start; ) {
+        const size_t wanted = std::min(audio::kMp3DecodeChunkFrames, end - start - done);
+        if (reader.read(dst + done * stride, wanted) != wanted) {
+            return false;
+        }
+        done += wanted;
+        if (!progress(done)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
 
 Mp3Adapter::Mp3Adapter(std::shared_ptr<ILogger> logger) 
     : logger_(std::move(logger))
@@ -22,6 +215,12 @@ bool Mp3Adapter::load(const std::string& filePath) {
         return false;
     }
     
+    // Float output lets mpg123 write straight into the final buffer. Builds
+    // with a fixed-point decoder cannot provide it and stay on 16-bit.
+    if (!restrictEncoding(mh, MPG123_ENC_FLOAT_32)) {
+        restrictEncoding(mh, MPG123_ENC_SIGNED_16);
+    }
+    
     if (mpg123_open(mh, filePath.c_str()) != MPG123_OK) {
         if (logger_) {
             logger_->error("Failed to open MP3 file: " + filePath);
@@ -42,10 +241,19 @@ bool Mp3Adapter::load(const std::string& filePath) {
         return false;
     }
     
+    if (encoding != MPG123_ENC_FLOAT_32 && encoding != MPG123_ENC_SIGNED_16) {
+        if (logger_) {
+            logger_->error("Unsupported MP3 output encoding: " + std::to_string(encoding));
+        }
+        mpg123_close(mh);
+        mpg123_delete(mh);
+        return false;
+    }
+    
     sampleRate_ = static_cast<int>(rate);
     channels_ = channels;
     
-    const off_t length = mpg123_length(mh);
+    off_t length = mpg123_length(mh);
     if (length == MPG123_ERR) {
         if (logger_) {
             logger_->error("Failed to get MP3 length");
@@ -55,27 +263,67 @@ bool Mp3Adapter::load(const std::string& filePath) {
         return false;
     }
     
-    duration_ = static_cast<float>(length) / static_cast<float>(sampleRate_);
+    deliveredFrames_ = 0;
+    cancelled_ = false;
     
-    samples_.clear();
-    samples_.reserve(static_cast<size_t>(length * channels_));
+    const unsigned threads = decodeThreads_ > 0
+        ? decodeThreads_ : std::max(1u, std::thread::hardware_concurrency());
+    const off_t minSegment = static_cast<off_t>(audio::kMp3MinSegmentFrames);
     
-    std::vector<unsigned char> buffer(audio::kMp3ReadBufferSize);
-    size_t done = 0;
+    // Worth splitting: scan the whole stream so the length is exact and the
+    // frame index covers every seek point the segments will need. Segments
+    // cut on an estimated length would truncate or overrun the clip, so
+    // without a scan the stream is decoded in one pass.
+    bool scanned = false;
+    if (threads > 1 && length >= 2 * minSegment) {
+        scanned = mpg123_scan(mh) == MPG123_OK;
+        if (scanned) {
+            length = mpg123_length(mh);
+        } else {
+            if (logger_) {
+                logger_->warning("MP3 scan failed, decoding sequentially");
+            }
+            mpg123_seek(mh, 0, SEEK_SET);
+        }
+    }
+    
+    duration_ = static_cast<float>(length) / static_cast<float>(sampleRate_);
+    
+    const size_t segments = scanned
+        ? std::min<size_t>(threads, static_cast<size_t>(length / minSegment)) : 1;
+    bool decoded = false;
     
-    while (mpg123_read(mh, buffer.data(), buffer.size(), &done) == MPG123_OK) {
-        for (size_t i = 0; i + 1 < done; i += 2) {
-            const auto sample = static_cast<short>((buffer[i + 1] << 8) | buffer[i]);
-            samples_.push_back(static_cast<float>(sample) / audio::kSampleNormalizationFactor);
+    if (segments > 1) {
+        decoded = decodeSegmented(filePath, mh, length, segments);
+        if (!decoded && !cancelled_) {
+            if (logger_) {
+                logger_->warning("Segmented MP3 decode failed, decoding sequentially");
+            }
+            mpg123_seek(mh, 0, SEEK_SET);
         }
     }
     
+    if (!decoded && !cancelled_) {
+        decoded = decodeSequential(mh, length, encoding == MPG123_ENC_FLOAT_32);
+    }
+    
     mpg123_close(mh);
     mpg123_delete(mh);
     
+    if (!decoded) {
+        samples_.clear();
+        if (logger_) {
+            logger_->log(cancelled_ ? "MP3 decode cancelled: " + filePath
+                                    : "MP3 decode failed: " + filePath);
+        }
+        return false;
+    }
+    
+    buffer_ = SampleBuffer(std::exchange(samples_, {}));
+    
     if (logger_) {
         logger_->log("Loaded MP3: " + filePath + 
-                     " (" + std::to_string(samples_.size()) + " samples, " + 
+                     " (" + std::to_string(buffer_.size()) + " samples, " + 
                      std::to_string(duration_) + "s, " + 
                      std::to_string(channels_) + " channels)");
     }
@@ -83,7 +331,161 @@ bool Mp3Adapter::load(const std::string& filePath) {
     return true;
 }
 
-bool Mp3Adapter::save(const std::string& filePath, const std::vector<float>& samples) {
+bool Mp3Adapter::deliver(size_t frame) {
+    if (!decodeCallback_ || frame <= deliveredFrames_) {
+        return true;
+    }
+    
+    const float* first = samples_.data() + deliveredFrames_ * static_cast<size_t>(channels_);
+    if (!decodeCallback_(first, frame - deliveredFrames_)) {
+        cancelled_ = true;
+        return false;
+    }
+    deliveredFrames_ = frame;
+    return true;
+}
+
+bool Mp3Adapter::decodeSequential(mpg123_handle* mh, off_t length, bool floatOutput) {
+    // The length is an estimate for VBR files without a Xing header, so leave
+    // one chunk of slack to reach the end of the stream without regrowing.
+    const size_t chunkSamples = audio::kMp3DecodeChunkFrames * static_cast<size_t>(channels_);
+    samples_.clear();
+    samples_.resize(static_cast<size_t>(std::max<off_t>(length, 0)) * channels_ + chunkSamples);
+    
+    std::vector<int16_t> pcm(floatOutput ? 0 : chunkSamples);
+    size_t filled = 0;
+    int result = MPG123_OK;
+    
+    while (result == MPG123_OK) {
+        if (filled == samples_.size()) {
+            samples_.resize(filled + std::max(chunkSamples, filled / 2 / chunkSamples * chunkSamples));
+        }
+        filled += readSamples(mh, samples_.data() + filled, samples_.size() - filled,
+                              floatOutput, pcm, result);
+        if (!deliver(filled / static_cast<size_t>(channels_))) {
+            return false;
+        }
+    }
+    
+    samples_.resize(filled);
+    if (samples_.capacity() - filled > 2 * chunkSamples) {
+        samples_.shrink_to_fit();
+    }
+    
+    // An error is not the end of the stream: a short clip would pass for
+    // the whole file.
+    if (result != MPG123_DONE) {
+        if (logger_) {
+            logger_->error("MP3 decoding stopped early: " + std::string(mpg123_strerror(mh)));
+        }
+        return false;
+    }
+    return true;
+}
+
+bool Mp3Adapter::decodeSegmented(const std::string& filePath, mpg123_handle* mh,
+                                 off_t length, size_t segments) {
+    FrameIndex index;
+    off_t* offsets = nullptr;
+    size_t fill = 0;
+    if (mpg123_index(mh, &offsets, &index.step, &fill) == MPG123_OK && offsets) {
+        index.offsets.assign(offsets, offsets + fill);
+    }
+    
+    // Boundaries fall on whole MPEG frames so no segment starts mid-frame.
+    const off_t spf = std::max(1, mpg123_spf(mh));
+    const off_t perSegment = ((length + static_cast<off_t>(segments) - 1) /
+                              static_cast<off_t>(segments) + spf - 1) / spf * spf;
+    const off_t overlap = static_cast<off_t>(audio::kMp3DecodeOverlapMpegFrames) * spf;
+    
+    samples_.assign(static_cast<size_t>(length) * channels_, 0.0f);
+    
+    // Workers post their progress here; this thread passes each segment on
+    // to the decode callback in file order while later ones still run.
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<size_t> decodedFrames(segments, 0);
+    std::vector<char> finished(segments, 0);
+    std::vector<char> succeeded(segments, 0);
+    std::atomic<bool> stop{false};
+    
+    std::vector<std::thread> workers;
+    workers.reserve(segments);
+    
+    for (size_t i = 0; i < segments; ++i) {
+        const off_t start = std::min(length, static_cast<off_t>(i) * perSegment);
+        const off_t end = std::min(length, start + perSegment);
+        const off_t warmStart = std::max<off_t>(0, start - overlap);
+        float* dst = samples_.data() + static_cast<size_t>(start) * channels_;
+        
+        workers.emplace_back([&, i, start, end, warmStart, dst]() {
+            const auto progress = [&](size_t frames) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    decodedFrames[i] = frames;
+                }
+                changed.notify_all();
+                return !stop.load();
+            };
+            const bool ok = decodeSegment(filePath, channels_, index, static_cast<size_t>(warmStart),
+                                          static_cast<size_t>(start), static_cast<size_t>(end),
+                                          dst, progress);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                succeeded[i] = ok;
+                finished[i] = 1;
+            }
+            changed.notify_all();
+        });
+    }
+    
+    bool ok = true;
+    size_t delivered = 0;
+    for (size_t i = 0; i < segments && ok; ) {
+        const size_t start = std::min(static_cast<size_t>(length), i * static_cast<size_t>(perSegment));
+        
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return finished[i] || start + decodedFrames[i] > delivered; });
+        const size_t ready = start + decodedFrames[i];
+        const bool done = finished[i] != 0;
+        ok = !done || succeeded[i];
+        lock.unlock();
+        
+        // The callback runs unlocked so workers never wait on it.
+        ok = ok && deliver(ready);
+        delivered = ready;
+        if (done) ++i;
+    }
+    
+    stop = !ok;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    if (!ok) {
+        samples_.clear();
+        return false;
+    }
+    
+    if (logger_) {
+        logger_->log("Decoded MP3 in " + std::to_string(segments) + " parallel segments");
+    }
+    return true;
+}
+
+std::unique_ptr<AudioStreamReader> Mp3Adapter::openReader(const std::string& filePath) const {
+    auto reader = std::make_unique<Mp3StreamReader>();
+    std::string error;
+    if (!reader->open(filePath, error)) {
+        if (logger_) {
+            logger_->error("Failed to open MP3 stream: " + filePath + " (" + error + ")");
+        }
+        return nullptr;
+    }
+    return reader;
+}
+
+bool Mp3Adapter::save(const std::string& filePath, const SampleBuffer& samples) {
     if (samples.empty()) {
         if (logger_) {
             logger_->error("Cannot save: empty sample buffer");
@@ -122,83 +524,30 @@ bool Mp3Adapter::save(const std::string& filePath, const std::vector<float>& sam
                      ", RMS: " + std::to_string(rms));
     }
     
-    lame_t lame = lame_init();
-    if (!lame) {
-        if (logger_) {
-            logger_->error("Failed to initialize LAME");
-        }
-        return false;
-    }
-    
-    lame_set_in_samplerate(lame, sampleRate_);
-    lame_set_num_channels(lame, channels_);
-    lame_set_quality(lame, 2);
+    const unsigned threads = encodeThreads_ > 0
+        ? encodeThreads_ : std::max(1u, std::thread::hardware_concurrency());
+    const size_t frames = samples.size() / static_cast<size_t>(channels_);
+    bool encoded = false;
     
-    if (lame_init_params(lame) < 0) {
-        if (logger_) {
-            logger_->error("Failed to initialize LAME parameters");
-        }
-        lame_close(lame);
-        return false;
-    }
-
-    FILE* file = fopen(filePath.c_str(), "wb");
-    if (!file) {
-        if (logger_) {
-            logger_->error("Failed to open output file: " + filePath);
+    if (ParallelMp3Encoder::segmentCount(frames, threads) > 1) {
+        ParallelMp3Encoder parallel(logger_);
+        encoded = parallel.encode(filePath, samples.data(), samples.size(),
+                                  sampleRate_, channels_, threads);
+        if (!encoded && logger_) {
+            logger_->warning("Segmented MP3 encode failed, encoding sequentially");
         }
-        lame_close(lame);
-        return false;
-    }
-
-    std::vector<short> intSamples(samples.size());
-    for (size_t i = 0; i < samples.size(); ++i) {
-        const float clamped = std::clamp(samples[i], -1.0f, 1.0f);
-        intSamples[i] = static_cast<short>(clamped * audio::kMaxSampleValue);
-    }
-
-    const size_t mp3BufferSize = audio::kMp3WriteBufferMultiplier + 
-                                  static_cast<size_t>(samples.size() / channels_ * 1.25);
-    std::vector<unsigned char> mp3Buffer(mp3BufferSize);
-    
-    int mp3Size = 0;
-    if (channels_ == 2) {
-        mp3Size = lame_encode_buffer_interleaved(
-            lame, 
-            intSamples.data(),
-            static_cast<int>(samples.size() / channels_), 
-            mp3Buffer.data(), 
-            static_cast<int>(mp3Buffer.size())
-        );
-    } else {
-        mp3Size = lame_encode_buffer(
-            lame, 
-            intSamples.data(), 
-            nullptr,
-            static_cast<int>(samples.size()), 
-            mp3Buffer.data(), 
-            static_cast<int>(mp3Buffer.size())
-        );
     }
     
-    if (mp3Size < 0) {
-        if (logger_) {
-            logger_->error("LAME encoding failed with error: " + std::to_string(mp3Size));
+    if (!encoded) {
+        Mp3Encoder encoder(logger_);
+        if (!encoder.open(filePath, sampleRate_, channels_)) {
+            return false;
+        }
+        
+        if (!encoder.write(samples.data(), samples.size()) || !encoder.finish()) {
+            return false;
         }
-        fclose(file);
-        lame_close(lame);
-        return false;
-    }
-    
-    fwrite(mp3Buffer.data(), 1, static_cast<size_t>(mp3Size), file);
-
-    mp3Size = lame_encode_flush(lame, mp3Buffer.data(), static_cast<int>(mp3Buffer.size()));
-    if (mp3Size > 0) {
-        fwrite(mp3Buffer.data(), 1, static_cast<size_t>(mp3Size), file);
     }
-
-    fclose(file);
-    lame_close(lame);
     
     if (logger_) {
         logger_->log("Successfully saved MP3: " + filePath);
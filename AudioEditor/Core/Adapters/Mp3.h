@@ -4,6 +4,11 @@
 #include "../Logging/ILogger.h"
 #include "../Constants.h"
 #include <memory>
+#include <sys/types.h>
+#include <utility>
+
+struct mpg123_handle_struct;
+typedef struct mpg123_handle_struct mpg123_handle;
 
 class Mp3Adapter : public AudioFileAdapter {
 public:
@@ -18,10 +23,16 @@ public:
     
     [[nodiscard]] bool load(const std::string& filePath) override;
     [[nodiscard]] bool save(const std::string& filePath, 
-                            const std::vector<float>& samples) override;
+                            const SampleBuffer& samples) override;
+    
+    [[nodiscard]] std::unique_ptr<AudioStreamReader> openReader(const std::string& filePath) const override;
     
-    [[nodiscard]] const std::vector<float>& getSamples() const override { 
-        return samples_; 
+    [[nodiscard]] const SampleBuffer& getSamples() const override { 
+        return buffer_; 
+    }
+    
+    [[nodiscard]] SampleBuffer takeSamples() override {
+        return std::exchange(buffer_, SampleBuffer());
     }
     
     [[nodiscard]] float getDuration() const noexcept override { 
@@ -36,10 +47,34 @@ public:
         return channels_; 
     }
     
+    void setFormat(int sampleRate, int channels) override {
+        sampleRate_ = sampleRate;
+        channels_ = channels;
+    }
+    
+    void setDecodeThreads(unsigned threads) override { decodeThreads_ = threads; }
+    void setEncodeThreads(unsigned threads) override { encodeThreads_ = threads; }
+    void setDecodeCallback(DecodeCallback callback) override { decodeCallback_ = std::move(callback); }
+    
 private:
+    [[nodiscard]] bool decodeSequential(mpg123_handle* mh, off_t length, bool floatOutput);
+    [[nodiscard]] bool decodeSegmented(const std::string& filePath, mpg123_handle* mh,
+                                       off_t length, size_t segments);
+    
+    // Passes samples_ up to frame on to the decode callback, skipping what
+    // it already has. False once the callback has abandoned the load.
+    [[nodiscard]] bool deliver(size_t frame);
+    
+    // Decode target; handed to buffer_ once load() completes.
     std::vector<float> samples_;
+    DecodeCallback decodeCallback_;
+    size_t deliveredFrames_ = 0;
+    bool cancelled_ = false;
+    SampleBuffer buffer_;
     float duration_ = 0.0f;
     int sampleRate_ = audio::kDefaultSampleRate;
     int channels_ = audio::kDefaultChannels;
+    unsigned decodeThreads_ = 0;
+    unsigned encodeThreads_ = 1;
     std::shared_ptr<ILogger> logger_;
 };
@@ -0,0 +1,206 @@
+#include "Mp3Encoder.h"
+#include "../Constants.h"
+#include "../Dsp/SampleKernels.h"
+#include <lame/lame.h>
+#include <algorithm>
+
+Mp3Encoder::Mp3Encoder(std::shared_ptr<ILogger> logger)
+    : logger_(std::move(logger))
+{
+}
+
+Mp3Encoder::~Mp3Encoder() {
+    if (file_) {
+        close();
+        std::remove(filePath_.c_str());
+    }
+    close();
+}
+
+bool Mp3Encoder::initLame(int sampleRate, int channels, const Mp3EncodeSettings& settings) {
+    lame_ = lame_init();
+    if (!lame_) {
+        if (logger_) {
+            logger_->error("Failed to initialize LAME");
+        }
+        return false;
+    }
+    
+    lame_set_in_samplerate(lame_, sampleRate);
+    lame_set_num_channels(lame_, channels);
+    lame_set_quality(lame_, 2);
+    lame_set_disable_reservoir(lame_, settings.bitReservoir ? 0 : 1);
+    lame_set_bWriteVbrTag(lame_, settings.vbrTag ? 1 : 0);
+    
+    if (lame_init_params(lame_) < 0) {
+        if (logger_) {
+            logger_->error("Failed to initialize LAME parameters");
+        }
+        close();
+        return false;
+    }
+    
+    channels_ = channels;
+    pcm_.resize(audio::kMp3EncodeChunkFrames * static_cast<size_t>(channels));
+    // LAME's documented worst case: 1.25 * frames + 7200 bytes.
+    mp3Buffer_.resize(audio::kMp3EncodeChunkFrames * 5 / 4 + audio::kMp3WriteBufferMultiplier);
+    
+    return true;
+}
+
+bool Mp3Encoder::open(const std::string& filePath, int sampleRate, int channels,
+                      const Mp3EncodeSettings& settings) {
+    if (!initLame(sampleRate, channels, settings)) {
+        return false;
+    }
+    
+    file_ = fopen(filePath.c_str(), "wb");
+    if (!file_) {
+        if (logger_) {
+            logger_->error("Failed to open output file: " + filePath);
+        }
+        close();
+        return false;
+    }
+    
+    filePath_ = filePath;
+    return true;
+}
+
+bool Mp3Encoder::openInMemory(int sampleRate, int channels, const Mp3EncodeSettings& settings) {
+    output_.clear();
+    return initLame(sampleRate, channels, settings);
+}
+
+int Mp3Encoder::frameSize() const {
+    return lame_ ? lame_get_framesize(lame_) : 0;
+}
+
+int Mp3Encoder::encoderDelay() const {
+    return lame_ ? lame_get_encoder_delay(lame_) : 0;
+}
+
+std::string Mp3Encoder::version() {
+    return get_lame_short_version();
+}
+
+bool Mp3Encoder::write(const float* samples, size_t count) {
+    if (!lame_) return false;
+    
+    const size_t channels = static_cast<size_t>(channels_);
+    for (size_t frame = 0, frames = count / channels; frame < frames; ) {
+        const size_t chunk = std::min(audio::kMp3EncodeChunkFrames, frames - frame);
+        if (!encodeChunk(samples + frame * channels, chunk)) {
+            return false;
+        }
+        frame += chunk;
+    }
+    
+    return true;
+}
+
+bool Mp3Encoder::encodeChunk(const float* samples, size_t frames) {
+    dsp::floatToInt16(samples, pcm_.data(), frames * channels_);
+    
+    int mp3Size = 0;
+    if (channels_ == 2) {
+        mp3Size = lame_encode_buffer_interleaved(
+            lame_,
+            pcm_.data(),
+            static_cast<int>(frames),
+            mp3Buffer_.data(),
+            static_cast<int>(mp3Buffer_.size())
+        );
+    } else {
+        mp3Size = lame_encode_buffer(
+            lame_,
+            pcm_.data(),
+            nullptr,
+            static_cast<int>(frames),
+            mp3Buffer_.data(),
+            static_cast<int>(mp3Buffer_.size())
+        );
+    }
+    
+    if (mp3Size < 0) {
+        if (logger_) {
+            logger_->error("LAME encoding failed with error: " + std::to_string(mp3Size));
+        }
+        return false;
+    }
+    
+    return writeOutput(mp3Size);
+}
+
+bool Mp3Encoder::writeOutput(int bytes) {
+    if (bytes <= 0) return true;
+    
+    if (!file_) {
+        output_.insert(output_.end(), mp3Buffer_.begin(), mp3Buffer_.begin() + bytes);
+        return true;
+    }
+    
+    if (fwrite(mp3Buffer_.data(), 1, static_cast<size_t>(bytes), file_) != static_cast<size_t>(bytes)) {
+        if (logger_) {
+            logger_->error("Failed to write MP3 data: " + filePath_);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool Mp3Encoder::writeVbrTag() {
+    // LAME reserves the first frame for the VBR/Info tag but can only fill
+    // it in once the whole stream is known; left alone it decodes as a frame
+    // of silence and hides the encoder delay from gapless decoders.
+    const size_t bytes = lame_get_lametag_frame(lame_, mp3Buffer_.data(), mp3Buffer_.size());
+    if (bytes == 0) return true;
+    
+    if (!file_) {
+        if (output_.size() < bytes) return false;
+        std::copy(mp3Buffer_.begin(), mp3Buffer_.begin() + static_cast<std::ptrdiff_t>(bytes),
+                  output_.begin());
+        return true;
+    }
+    
+    if (fseek(file_, 0, SEEK_SET) != 0 || fwrite(mp3Buffer_.data(), 1, bytes, file_) != bytes) {
+        if (logger_) {
+            logger_->error("Failed to write MP3 VBR tag: " + filePath_);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool Mp3Encoder::finish() {
+    if (!lame_) return false;
+    
+    const int mp3Size = lame_encode_flush(lame_, mp3Buffer_.data(), static_cast<int>(mp3Buffer_.size()));
+    bool ok = mp3Size >= 0 && writeOutput(mp3Size) && writeVbrTag();
+    
+    if (file_) {
+        ok = fclose(file_) == 0 && ok;
+        file_ = nullptr;
+        
+        if (!ok) {
+            if (logger_) {
+                logger_->error("Failed to finish MP3 file: " + filePath_);
+            }
+            std::remove(filePath_.c_str());
+        }
+    }
+    
+    close();
+    return ok;
+}
+
+void Mp3Encoder::close() {
+    if (file_) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+    if (lame_) {
+        lame_close(lame_);
+        lame_ = nullptr;
+    }
+}
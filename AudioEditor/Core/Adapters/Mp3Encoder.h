@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../Logging/ILogger.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct lame_global_struct;
+
+struct Mp3EncodeSettings {
+    // Without the reservoir every frame is self-contained, so runs encoded
+    // independently can be spliced at any frame boundary.
+    bool bitReservoir = true;
+    // Starts the stream with LAME's VBR/Info frame, filled in by finish().
+    bool vbrTag = true;
+};
+
+// Incremental LAME encoder writing to a file or to memory. Blocks of
+// interleaved float samples are converted, encoded and written as they
+// arrive, so memory use does not depend on the clip length and a producer
+// can feed it block by block.
+class Mp3Encoder {
+public:
+    explicit Mp3Encoder(std::shared_ptr<ILogger> logger);
+    ~Mp3Encoder();
+
+    Mp3Encoder(const Mp3Encoder&) = delete;
+    Mp3Encoder& operator=(const Mp3Encoder&) = delete;
+
+    [[nodiscard]] bool open(const std::string& filePath, int sampleRate, int channels,
+                            const Mp3EncodeSettings& settings = Mp3EncodeSettings());
+
+    // Collects the encoded stream instead of writing a file; see takeOutput().
+    [[nodiscard]] bool openInMemory(int sampleRate, int channels,
+                                    const Mp3EncodeSettings& settings = Mp3EncodeSettings());
+
+    // Accepts any number of interleaved samples; a partial frame is not allowed.
+    [[nodiscard]] bool write(const float* samples, size_t count);
+
+    // Flushes LAME and closes the file. Without it the output is discarded as
+    // incomplete and the file is removed.
+    [[nodiscard]] bool finish();
+
+    [[nodiscard]] std::vector<unsigned char> takeOutput() { return std::move(output_); }
+
+    // Samples per channel in one MPEG frame.
+    [[nodiscard]] int frameSize() const;
+
+    // Samples per channel LAME puts in front of the clip.
+    [[nodiscard]] int encoderDelay() const;
+
+    // LAME's short version string, e.g. "3.100".
+    [[nodiscard]] static std::string version();
+
+    [[nodiscard]] bool isOpen() const noexcept { return lame_ != nullptr; }
+
+private:
+    [[nodiscard]] bool initLame(int sampleRate, int channels, const Mp3EncodeSettings& settings);
+    [[nodiscard]] bool encodeChunk(const float* samples, size_t frames);
+    [[nodiscard]] bool writeOutput(int bytes);
+    [[nodiscard]] bool writeVbrTag();
+    void close();
+
+    std::shared_ptr<ILogger> logger_;
+    lame_global_struct* lame_ = nullptr;
+    FILE* file_ = nullptr;
+    std::string filePath_;
+    int channels_ = 0;
+    std::vector<short> pcm_;
+    std::vector<unsigned char> mp3Buffer_;
+    std::vector<unsigned char> output_;
+};
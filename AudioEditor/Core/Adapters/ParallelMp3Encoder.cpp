@@ -0,0 +1,269 @@
+#include "ParallelMp3Encoder.h"
+#include "Mp3Encoder.h"
+#include "../Constants.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+constexpr int kMpeg1BitratesKbps[16] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0};
+constexpr int kMpeg2BitratesKbps[16] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0};
+constexpr int kMpeg1SampleRates[3] = {44100, 48000, 32000};
+
+// Byte length of the Layer III frame whose header starts at p, or 0 when p
+// does not hold a valid header.
+size_t layer3FrameBytes(const unsigned char* p, size_t available) {
+    if (available < 4 || p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) return 0;
+    
+    const int version = (p[1] >> 3) & 0x03;  // 3 = MPEG-1, 2 = MPEG-2, 0 = MPEG-2.5
+    const int layer = (p[1] >> 1) & 0x03;    // 1 = Layer III
+    const int bitrateIndex = (p[2] >> 4) & 0x0F;
+    const int rateIndex = (p[2] >> 2) & 0x03;
+    const int padding = (p[2] >> 1) & 0x01;
+    if (version == 1 || layer != 1 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) {
+        return 0;
+    }
+    
+    const bool mpeg1 = version == 3;
+    const int divisor = version == 3 ? 1 : (version == 2 ? 2 : 4);
+    const int sampleRate = kMpeg1SampleRates[rateIndex] / divisor;
+    const int bitrate = (mpeg1 ? kMpeg1BitratesKbps : kMpeg2BitratesKbps)[bitrateIndex] * 1000;
+    
+    return static_cast<size_t>((mpeg1 ? 144 : 72) * bitrate / sampleRate + padding);
+}
+
+// Start offsets of the consecutive frames in stream, plus a final entry
+// holding the end of the last complete frame.
+std::vector<size_t> frameOffsets(const std::vector<unsigned char>& stream) {
+    std::vector<size_t> offsets{0};
+    size_t pos = 0;
+    while (const size_t bytes = layer3FrameBytes(stream.data() + pos, stream.size() - pos)) {
+        if (pos + bytes > stream.size()) break;
+        pos += bytes;
+        offsets.push_back(pos);
+    }
+    return offsets;
+}
+
+// CRC-16 as LAME computes it over the Info frame and the music data
+// (polynomial 0x8005, bit-reversed).
+uint16_t crc16(uint16_t crc, const unsigned char* data, size_t size) {
+    static const std::array<uint16_t, 256> table = [] {
+        std::array<uint16_t, 256> entries{};
+        for (unsigned i = 0; i < entries.size(); ++i) {
+            auto value = static_cast<uint16_t>(i);
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1) ? static_cast<uint16_t>((value >> 1) ^ 0xA001) : value >> 1;
+            }
+            entries[i] = value;
+        }
+        return entries;
+    }();
+    
+    for (size_t i = 0; i < size; ++i) {
+        crc = static_cast<uint16_t>((crc >> 8) ^ table[(crc ^ data[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+void putBigEndian(unsigned char* p, uint32_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) {
+        p[i] = static_cast<unsigned char>(value & 0xFF);
+        value >>= 8;
+    }
+}
+
+// The Xing "Info" frame with LAME's extension that a tagged serial encode
+// starts with. Its delay and padding fields let decoders trim the joined
+// stream back to the clip's length. header is the first audio frame's; the
+// result is empty when no bitrate gives a frame large enough for the tag.
+std::vector<unsigned char> infoFrame(const unsigned char* header, size_t audioFrames,
+                                     size_t audioBytes, uint16_t musicCrc,
+                                     size_t delay, size_t padding) {
+    constexpr size_t kXingBytes = 120;
+    constexpr size_t kLameBytes = 36;
+    
+    unsigned char h[4] = {0xFF, static_cast<unsigned char>(header[1] | 0x01),
+                          static_cast<unsigned char>(header[2] & 0xFC), header[3]};
+    const bool mpeg1 = ((h[1] >> 3) & 0x03) == 3;
+    const bool mono = (h[3] >> 6) == 3;
+    const size_t tagStart = 4 + (mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17));
+    
+    size_t bytes = layer3FrameBytes(h, sizeof(h));
+    while (bytes < tagStart + kXingBytes + kLameBytes && (h[2] >> 4) < 14) {
+        h[2] = static_cast<unsigned char>(h[2] + 0x10);
+        bytes = layer3FrameBytes(h, sizeof(h));
+    }
+    if (bytes < tagStart + kXingBytes + kLameBytes) return {};
+    
+    std::vector<unsigned char> frame(bytes, 0);
+    std::memcpy(frame.data(), h, sizeof(h));
+    const auto streamBytes = static_cast<uint32_t>(bytes + audioBytes);
+    
+    unsigned char* xing = frame.data() + tagStart;
+    std::memcpy(xing, "Info", 4);
+    putBigEndian(xing + 4, 0x0F, 4);  // frames, bytes, TOC and quality present
+    putBigEndian(xing + 8, static_cast<uint32_t>(audioFrames), 4);
+    putBigEndian(xing + 12, streamBytes, 4);
+    for (int i = 0; i < 100; ++i) {
+        xing[16 + i] = static_cast<unsigned char>(i * 256 / 100);
+    }
+    
+    unsigned char* lame = xing + kXingBytes;
+    const std::string encoder = "LAME" + Mp3Encoder::version();
+    std::memcpy(lame, encoder.data(), std::min<size_t>(9, encoder.size()));
+    lame[9] = 0x01;  // tag revision 0, CBR
+    const int bitrateIndex = (header[2] >> 4) & 0x0F;
+    lame[20] = static_cast<unsigned char>(
+        std::min(255, (mpeg1 ? kMpeg1BitratesKbps : kMpeg2BitratesKbps)[bitrateIndex]));
+    const auto delayField = static_cast<uint32_t>(std::min<size_t>(delay, 0xFFF));
+    const auto paddingField = static_cast<uint32_t>(std::min<size_t>(padding, 0xFFF));
+    putBigEndian(lame + 21, delayField << 12 | paddingField, 3);
+    putBigEndian(lame + 28, streamBytes, 4);
+    putBigEndian(lame + 32, musicCrc, 2);
+    
+    const size_t tagCrcOffset = static_cast<size_t>(lame + 34 - frame.data());
+    putBigEndian(lame + 34, crc16(0, frame.data(), tagCrcOffset), 2);
+    return frame;
+}
+
+}
+
+ParallelMp3Encoder::ParallelMp3Encoder(std::shared_ptr<ILogger> logger)
+    : logger_(std::move(logger))
+{
+}
+
+size_t ParallelMp3Encoder::segmentCount(size_t frames, unsigned threads) {
+    return std::max<size_t>(1, std::min<size_t>(threads, frames / audio::kMp3MinSegmentFrames));
+}
+
+bool ParallelMp3Encoder::encodeSegment(const float* samples, size_t totalFrames, int sampleRate,
+                                       int channels, size_t spf, size_t start, size_t end,
+                                       bool last, std::vector<unsigned char>& output) const {
+    const size_t overlap = audio::kMp3EncodeOverlapMpegFrames * spf;
+    const size_t feedStart = start >= overlap ? start - overlap : 0;
+    const size_t feedEnd = last ? totalFrames : std::min(totalFrames, end + overlap);
+    
+    Mp3Encoder encoder(logger_);
+    Mp3EncodeSettings settings;
+    settings.bitReservoir = false;
+    settings.vbrTag = false;
+    
+    if (!encoder.openInMemory(sampleRate, channels, settings) ||
+        !encoder.write(samples + feedStart * channels, (feedEnd - feedStart) * channels) ||
+        !encoder.finish()) {
+        return false;
+    }
+    
+    // feedStart is frame-aligned, so local frame j here is frame
+    // j + feedStart / spf of a serial encode.
+    const std::vector<unsigned char> stream = encoder.takeOutput();
+    const std::vector<size_t> offsets = frameOffsets(stream);
+    const size_t available = offsets.size() - 1;
+    const size_t first = (start - feedStart) / spf;
+    const size_t count = last ? available - std::min(available, first) : (end - start) / spf;
+    
+    if (first + count > available || count == 0) {
+        if (logger_) {
+            logger_->error("MP3 segment encoder produced " + std::to_string(available) +
+                           " frames, expected at least " + std::to_string(first + count));
+        }
+        return false;
+    }
+    
+    output.assign(stream.begin() + static_cast<std::ptrdiff_t>(offsets[first]),
+                  stream.begin() + static_cast<std::ptrdiff_t>(offsets[first + count]));
+    return true;
+}
+
+bool ParallelMp3Encoder::encode(const std::string& filePath, const float* samples, size_t count,
+                                int sampleRate, int channels, unsigned threads) {
+    if (channels <= 0) return false;
+    const size_t totalFrames = count / static_cast<size_t>(channels);
+    
+    Mp3Encoder probe(logger_);
+    if (!probe.openInMemory(sampleRate, channels)) {
+        return false;
+    }
+    const size_t spf = static_cast<size_t>(std::max(1, probe.frameSize()));
+    const size_t delay = static_cast<size_t>(std::max(0, probe.encoderDelay()));
+    
+    const size_t segments = segmentCount(totalFrames, threads);
+    const size_t perSegment = ((totalFrames + segments - 1) / segments + spf - 1) / spf * spf;
+    
+    std::vector<std::vector<unsigned char>> outputs(segments);
+    std::vector<char> succeeded(segments, 0);
+    std::vector<std::thread> workers;
+    workers.reserve(segments);
+    
+    for (size_t i = 0; i < segments; ++i) {
+        const size_t start = std::min(totalFrames, i * perSegment);
+        const size_t end = std::min(totalFrames, start + perSegment);
+        const bool last = i + 1 == segments;
+        
+        workers.emplace_back([&, i, start, end, last]() {
+            succeeded[i] = encodeSegment(samples, totalFrames, sampleRate, channels, spf,
+                                         start, end, last, outputs[i]);
+        });
+    }
+    
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    if (std::find(succeeded.begin(), succeeded.end(), 0) != succeeded.end()) {
+        return false;
+    }
+    
+    size_t audioFrames = 0;
+    size_t audioBytes = 0;
+    uint16_t musicCrc = 0;
+    for (const auto& output : outputs) {
+        audioFrames += frameOffsets(output).size() - 1;
+        audioBytes += output.size();
+        musicCrc = crc16(musicCrc, output.data(), output.size());
+    }
+    
+    const size_t coded = audioFrames * spf;
+    const size_t padding = coded > delay + totalFrames ? coded - delay - totalFrames : 0;
+    const std::vector<unsigned char> tag = infoFrame(outputs.front().data(), audioFrames,
+                                                     audioBytes, musicCrc, delay, padding);
+    if (tag.empty()) {
+        if (logger_) {
+            logger_->error("No MPEG frame size fits the LAME Info tag");
+        }
+        return false;
+    }
+    
+    FILE* file = fopen(filePath.c_str(), "wb");
+    if (!file) {
+        if (logger_) {
+            logger_->error("Failed to open output file: " + filePath);
+        }
+        return false;
+    }
+    
+    bool ok = fwrite(tag.data(), 1, tag.size(), file) == tag.size();
+    for (const auto& output : outputs) {
+        ok = ok && fwrite(output.data(), 1, output.size(), file) == output.size();
+    }
+    ok = fclose(file) == 0 && ok;
+    
+    if (!ok) {
+        if (logger_) {
+            logger_->error("Failed to write MP3 data: " + filePath);
+        }
+        std::remove(filePath.c_str());
+        return false;
+    }
+    
+    if (logger_) {
+        logger_->log("Encoded MP3 in " + std::to_string(segments) + " parallel segments");
+    }
+    return true;
+}
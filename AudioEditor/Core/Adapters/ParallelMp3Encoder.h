@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../Logging/ILogger.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Encodes a clip as independent segments on separate threads and splices the
+// resulting MPEG frames into one file. Every segment encoder starts on an MPEG
+// frame boundary of the whole clip, so its frames line up with the frames a
+// serial encode would produce. Each one also encodes a few frames before and
+// after its own range so psychoacoustic and MDCT state are settled at the
+// seams; those frames, along with each segment's encoder delay and flush
+// padding, are dropped. The bit reservoir is disabled so that frames from
+// different encoders can be concatenated. The joined frames are preceded by a
+// LAME Info frame carrying the clip's encoder delay and padding, as a serial
+// encode is, so decoders play it back gaplessly at the clip's length.
+class ParallelMp3Encoder {
+public:
+    explicit ParallelMp3Encoder(std::shared_ptr<ILogger> logger);
+
+    [[nodiscard]] bool encode(const std::string& filePath, const float* samples, size_t count,
+                              int sampleRate, int channels, unsigned threads);
+
+    // Number of segments encode() would use for a clip of the given length.
+    [[nodiscard]] static size_t segmentCount(size_t frames, unsigned threads);
+
+private:
+    [[nodiscard]] bool encodeSegment(const float* samples, size_t totalFrames, int sampleRate,
+                                     int channels, size_t spf, size_t start, size_t end,
+                                     bool last, std::vector<unsigned char>& output) const;
+
+    std::shared_ptr<ILogger> logger_;
+};
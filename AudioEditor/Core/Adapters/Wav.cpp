@@ -0,0 +1,451 @@
+#include "Wav.h"
+#include "MappedFile.h"
+#include "../Dsp/SampleKernels.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#if defined(__BYTE_ORDER__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "WavAdapter maps little-endian sample data directly");
+#endif
+
+namespace {
+
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+constexpr uint32_t kRf64Placeholder = 0xFFFFFFFF;
+
+struct WavLayout {
+    uint16_t formatTag = 0;
+    uint16_t channels = 0;
+    uint32_t sampleRate = 0;
+    uint16_t blockAlign = 0;
+    uint16_t bitsPerSample = 0;
+    size_t dataOffset = 0;
+    uint64_t dataBytes = 0;
+    bool hasFormat = false;
+    bool hasData = false;
+};
+
+uint16_t readLe16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | p[1] << 8);
+}
+
+uint32_t readLe32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+uint64_t readLe64(const unsigned char* p) {
+    return static_cast<uint64_t>(readLe32(p)) | static_cast<uint64_t>(readLe32(p + 4)) << 32;
+}
+
+bool hasId(const unsigned char* p, const char* id) {
+    return std::memcmp(p, id, 4) == 0;
+}
+
+bool isWaveHeader(const unsigned char* p) {
+    return (hasId(p, "RIFF") || hasId(p, "RF64") || hasId(p, "BW64")) && hasId(p + 8, "WAVE");
+}
+
+bool parseLayout(const unsigned char* file, size_t size, WavLayout& layout, std::string& error) {
+    if (size < 12 || !isWaveHeader(file)) {
+        error = "not a WAVE file";
+        return false;
+    }
+    
+    uint64_t ds64DataBytes = 0;
+    size_t pos = 12;
+    
+    while (pos + 8 <= size && !layout.hasData) {
+        const unsigned char* chunk = file + pos;
+        const uint32_t chunkSize = readLe32(chunk + 4);
+        const unsigned char* body = chunk + 8;
+        const size_t available = size - pos - 8;
+        
+        if (hasId(chunk, "ds64") && available >= 16) {
+            ds64DataBytes = readLe64(body + 8);
+        } else if (hasId(chunk, "fmt ") && available >= 16 && chunkSize >= 16) {
+            layout.formatTag = readLe16(body);
+            layout.channels = readLe16(body + 2);
+            layout.sampleRate = readLe32(body + 4);
+            layout.blockAlign = readLe16(body + 12);
+            layout.bitsPerSample = readLe16(body + 14);
+            // The sub-format GUID of WAVE_FORMAT_EXTENSIBLE starts with the real tag.
+            if (layout.formatTag == kFormatExtensible && chunkSize >= 40 && available >= 40) {
+                layout.formatTag = readLe16(body + 24);
+            }
+            layout.hasFormat = true;
+        } else if (hasId(chunk, "data")) {
+            layout.dataOffset = pos + 8;
+            layout.dataBytes = chunkSize == kRf64Placeholder && ds64DataBytes > 0
+                ? ds64DataBytes : chunkSize;
+            // Tolerate files whose writer never patched the size or that were cut short.
+            layout.dataBytes = std::min<uint64_t>(layout.dataBytes, available);
+            layout.hasData = true;
+        }
+        
+        pos += 8 + static_cast<size_t>(chunkSize) + (chunkSize & 1);
+    }
+    
+    if (!layout.hasFormat || !layout.hasData) {
+        error = layout.hasFormat ? "missing data chunk" : "missing fmt chunk";
+        return false;
+    }
+    
+    const bool isInt = layout.formatTag == kFormatPcm &&
+        (layout.bitsPerSample == 8 || layout.bitsPerSample == 16 ||
+         layout.bitsPerSample == 24 || layout.bitsPerSample == 32);
+    const bool isFloat = layout.formatTag == kFormatFloat &&
+        (layout.bitsPerSample == 32 || layout.bitsPerSample == 64);
+    
+    if (!isInt && !isFloat) {
+        error = "unsupported sample format (tag " + std::to_string(layout.formatTag) +
+                ", " + std::to_string(layout.bitsPerSample) + " bits)";
+        return false;
+    }
+    
+    if (layout.channels == 0 || layout.sampleRate == 0 ||
+        layout.blockAlign != layout.channels * layout.bitsPerSample / 8) {
+        error = "inconsistent fmt chunk";
+        return false;
+    }
+    
+    return true;
+}
+
+void convertToFloat(const unsigned char* src, size_t count, const WavLayout& layout, float* dst) {
+    if (layout.formatTag == kFormatFloat && layout.bitsPerSample == 32) {
+        std::memcpy(dst, src, count * sizeof(float));
+        return;
+    }
+    
+    if (layout.formatTag == kFormatFloat) {
+        for (size_t i = 0; i < count; ++i) {
+            double value;
+            std::memcpy(&value, src + i * 8, sizeof(value));
+            dst[i] = static_cast<float>(value);
+        }
+        return;
+    }
+    
+    switch (layout.bitsPerSample) {
+        case 8:
+            for (size_t i = 0; i < count; ++i) {
+                dst[i] = (static_cast<float>(src[i]) - 128.0f) / 128.0f;
+            }
+            break;
+        case 16:
+            if (reinterpret_cast<uintptr_t>(src) % alignof(int16_t) == 0) {
+                dsp::int16ToFloat(reinterpret_cast<const int16_t*>(src), dst, count);
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    dst[i] = static_cast<int16_t>(readLe16(src + i * 2)) /
+                             audio::kSampleNormalizationFactor;
+                }
+            }
+            break;
+        case 24:
+            for (size_t i = 0; i < count; ++i) {
+                const unsigned char* p = src + i * 3;
+                const int32_t value = static_cast<int32_t>(
+                    static_cast<uint32_t>(p[0]) << 8 | static_cast<uint32_t>(p[1]) << 16 |
+                    static_cast<uint32_t>(p[2]) << 24) >> 8;
+                dst[i] = static_cast<float>(value) / 8388608.0f;
+            }
+            break;
+        default:
+            for (size_t i = 0; i < count; ++i) {
+                dst[i] = static_cast<float>(static_cast<int32_t>(readLe32(src + i * 4))) /
+                         2147483648.0f;
+            }
+            break;
+    }
+}
+
+class WavStreamReader : public AudioStreamReader {
+public:
+    WavStreamReader(std::shared_ptr<const MappedFile> file, const WavLayout& layout)
+        : file_(std::move(file))
+        , layout_(layout)
+        , totalFrames_(static_cast<size_t>(layout.dataBytes / layout.blockAlign))
+    {
+    }
+    
+    [[nodiscard]] int getSampleRate() const noexcept override { return static_cast<int>(layout_.sampleRate); }
+    [[nodiscard]] int getChannels() const noexcept override { return layout_.channels; }
+    [[nodiscard]] size_t totalFrames() const noexcept override { return totalFrames_; }
+    [[nodiscard]] size_t position() const noexcept override { return position_; }
+    
+    [[nodiscard]] size_t read(float* buffer, size_t frames) override {
+        frames = std::min(frames, totalFrames_ - position_);
+        const unsigned char* src = file_->data() + layout_.dataOffset +
+                                   position_ * layout_.blockAlign;
+        convertToFloat(src, frames * layout_.channels, layout_, buffer);
+        position_ += frames;
+        return frames;
+    }
+    
+    [[nodiscard]] bool seek(size_t frame) override {
+        if (frame > totalFrames_) return false;
+        position_ = frame;
+        return true;
+    }
+    
+private:
+    std::shared_ptr<const MappedFile> file_;
+    WavLayout layout_;
+    size_t totalFrames_;
+    size_t position_ = 0;
+};
+
+void putId(std::vector<unsigned char>& out, const char* id) {
+    out.insert(out.end(), id, id + 4);
+}
+
+void putLe(std::vector<unsigned char>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+// RIFF header, a JUNK chunk reserving room for ds64, fmt, fact, and a padding
+// chunk that puts the samples on a 16-byte file offset so the file can be
+// mapped in place when it is opened again. The length does not depend on
+// frames, so a streamed file can have its header rewritten at the end.
+std::vector<unsigned char> buildFloatHeader(int sampleRate, int channels, uint64_t frames) {
+    const uint64_t dataBytes = frames * static_cast<uint64_t>(channels) * sizeof(float);
+    const uint32_t blockAlign = static_cast<uint32_t>(channels) * sizeof(float);
+    
+    constexpr size_t kHeaderBeforePad = 12 + (8 + 28) + (8 + 18) + (8 + 4);
+    const size_t padBytes = (16 - (kHeaderBeforePad + 8 + 8) % 16) % 16;
+    const uint64_t riffBytes = kHeaderBeforePad + 8 + padBytes + 8 + dataBytes - 8;
+    const bool rf64 = riffBytes > kRf64Placeholder;
+    
+    std::vector<unsigned char> header;
+    putId(header, rf64 ? "RF64" : "RIFF");
+    putLe(header, rf64 ? kRf64Placeholder : riffBytes, 4);
+    putId(header, "WAVE");
+    
+    putId(header, rf64 ? "ds64" : "JUNK");
+    putLe(header, 28, 4);
+    putLe(header, rf64 ? riffBytes : 0, 8);
+    putLe(header, rf64 ? dataBytes : 0, 8);
+    putLe(header, rf64 ? frames : 0, 8);
+    putLe(header, 0, 4);
+    
+    putId(header, "fmt ");
+    putLe(header, 18, 4);
+    putLe(header, kFormatFloat, 2);
+    putLe(header, static_cast<uint64_t>(channels), 2);
+    putLe(header, static_cast<uint64_t>(sampleRate), 4);
+    putLe(header, static_cast<uint64_t>(sampleRate) * blockAlign, 4);
+    putLe(header, blockAlign, 2);
+    putLe(header, 32, 2);
+    putLe(header, 0, 2);
+    
+    putId(header, "fact");
+    putLe(header, 4, 4);
+    putLe(header, rf64 ? kRf64Placeholder : frames, 4);
+    
+    putId(header, "JUNK");
+    putLe(header, padBytes, 4);
+    header.insert(header.end(), padBytes, 0);
+    
+    putId(header, "data");
+    putLe(header, rf64 ? kRf64Placeholder : dataBytes, 4);
+    return header;
+}
+
+}
+
+WavAdapter::WavAdapter(std::shared_ptr<ILogger> logger) 
+    : logger_(std::move(logger))
+{
+}
+
+bool WavAdapter::isWavFile(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    unsigned char header[12] = {};
+    return file.read(reinterpret_cast<char*>(header), sizeof(header)) && isWaveHeader(header);
+}
+
+bool WavAdapter::load(const std::string& filePath) {
+    if (logger_) {
+        logger_->log("Loading WAV file from: " + filePath);
+    }
+    
+    std::string error;
+    std::shared_ptr<const MappedFile> file = MappedFile::open(filePath, error);
+    if (!file) {
+        if (logger_) {
+            logger_->error("Failed to map WAV file: " + filePath + " (" + error + ")");
+        }
+        return false;
+    }
+    
+    WavLayout layout;
+    if (!parseLayout(file->data(), file->size(), layout, error)) {
+        if (logger_) {
+            logger_->error("Failed to read WAV file: " + filePath + " (" + error + ")");
+        }
+        return false;
+    }
+    
+    sampleRate_ = static_cast<int>(layout.sampleRate);
+    channels_ = layout.channels;
+    
+    const size_t frames = static_cast<size_t>(layout.dataBytes / layout.blockAlign);
+    const size_t count = frames * layout.channels;
+    const unsigned char* data = file->data() + layout.dataOffset;
+    
+    const bool inPlace = layout.formatTag == kFormatFloat && layout.bitsPerSample == 32 &&
+                         reinterpret_cast<uintptr_t>(data) % alignof(float) == 0;
+    
+    if (inPlace) {
+        samples_ = SampleBuffer(file, reinterpret_cast<const float*>(data), count);
+    } else {
+        file->adviseSequential();
+        std::vector<float> converted(count);
+        convertToFloat(data, count, layout, converted.data());
+        samples_ = SampleBuffer(std::move(converted));
+    }
+    
+    duration_ = static_cast<float>(frames) / static_cast<float>(sampleRate_);
+    
+    if (logger_) {
+        logger_->log("Loaded WAV: " + filePath + 
+                     " (" + std::to_string(count) + " samples, " + 
+                     std::to_string(duration_) + "s, " + 
+                     std::to_string(channels_) + " channels, " +
+                     std::to_string(layout.bitsPerSample) + "-bit" +
+                     (inPlace ? ", mapped" : "") + ")");
+    }
+    
+    return true;
+}
+
+std::unique_ptr<AudioStreamReader> WavAdapter::openReader(const std::string& filePath) const {
+    std::string error;
+    std::shared_ptr<const MappedFile> file = MappedFile::open(filePath, error);
+    WavLayout layout;
+    if (!file || !parseLayout(file->data(), file->size(), layout, error)) {
+        if (logger_) {
+            logger_->error("Failed to open WAV stream: " + filePath + " (" + error + ")");
+        }
+        return nullptr;
+    }
+    return std::make_unique<WavStreamReader>(std::move(file), layout);
+}
+
+bool WavAdapter::save(const std::string& filePath, const SampleBuffer& samples) {
+    if (samples.empty()) {
+        if (logger_) {
+            logger_->error("Cannot save: empty sample buffer");
+        }
+        return false;
+    }
+    
+    if (logger_) {
+        logger_->log("Saving WAV: " + filePath);
+    }
+    
+    WavWriter writer(logger_);
+    if (!writer.open(filePath, sampleRate_, channels_) ||
+        !writer.write(samples.data(), samples.size()) ||
+        !writer.finish()) {
+        return false;
+    }
+    
+    if (logger_) {
+        logger_->log("Successfully saved WAV: " + filePath);
+    }
+    
+    return true;
+}
+
+WavWriter::WavWriter(std::shared_ptr<ILogger> logger)
+    : logger_(std::move(logger))
+{
+}
+
+WavWriter::~WavWriter() {
+    if (file_) {
+        fclose(file_);
+        std::remove(temporaryPath_.c_str());
+    }
+}
+
+bool WavWriter::open(const std::string& filePath, int sampleRate, int channels) {
+    if (channels <= 0 || sampleRate <= 0) {
+        if (logger_) {
+            logger_->error("Cannot save: invalid format (" + std::to_string(sampleRate) +
+                           " Hz, " + std::to_string(channels) + " channels)");
+        }
+        return false;
+    }
+    
+    // The target may be the mapped source of the samples being written, so
+    // it is replaced only once the new file is complete.
+    temporaryPath_ = filePath + ".tmp";
+    file_ = fopen(temporaryPath_.c_str(), "wb");
+    if (!file_) {
+        if (logger_) {
+            logger_->error("Failed to open output file: " + temporaryPath_);
+        }
+        return false;
+    }
+    
+    filePath_ = filePath;
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    frames_ = 0;
+    
+    const std::vector<unsigned char> header = buildFloatHeader(sampleRate_, channels_, 0);
+    return writeBytes(header.data(), header.size());
+}
+
+bool WavWriter::write(const float* samples, size_t count) {
+    if (!file_) return false;
+    
+    const size_t frames = count / static_cast<size_t>(channels_);
+    const size_t whole = frames * static_cast<size_t>(channels_);
+    if (!writeBytes(samples, whole * sizeof(float))) {
+        return false;
+    }
+    
+    frames_ += frames;
+    return true;
+}
+
+bool WavWriter::finish() {
+    if (!file_) return false;
+    
+    const std::vector<unsigned char> header = buildFloatHeader(sampleRate_, channels_, frames_);
+    bool ok = fseek(file_, 0, SEEK_SET) == 0 && writeBytes(header.data(), header.size());
+    ok = fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    ok = ok && std::rename(temporaryPath_.c_str(), filePath_.c_str()) == 0;
+    
+    if (!ok) {
+        if (logger_) {
+            logger_->error("Failed to finish WAV file: " + filePath_);
+        }
+        std::remove(temporaryPath_.c_str());
+    }
+    return ok;
+}
+
+bool WavWriter::writeBytes(const void* data, size_t bytes) {
+    if (fwrite(data, 1, bytes, file_) != bytes) {
+        if (logger_) {
+            logger_->error("Failed to write WAV data: " + filePath_);
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "AudioFileAdapter.h"
+#include "../Logging/ILogger.h"
+#include "../Constants.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <utility>
+
+// RIFF/RF64/BW64 WAVE files: 8/16/24/32-bit integer and 32/64-bit float PCM,
+// plain or WAVE_FORMAT_EXTENSIBLE. The file is memory-mapped; 32-bit float
+// data is used in place from the page cache and other formats are converted
+// in a single pass straight from the mapping.
+class WavAdapter : public AudioFileAdapter {
+public:
+    explicit WavAdapter(std::shared_ptr<ILogger> logger);
+    ~WavAdapter() override = default;
+    
+    WavAdapter(const WavAdapter&) = delete;
+    WavAdapter& operator=(const WavAdapter&) = delete;
+    
+    WavAdapter(WavAdapter&&) = default;
+    WavAdapter& operator=(WavAdapter&&) = default;
+    
+    [[nodiscard]] bool load(const std::string& filePath) override;
+    
+    // Writes 32-bit float, switching to RF64 when the file exceeds 4 GB.
+    [[nodiscard]] bool save(const std::string& filePath, 
+                            const SampleBuffer& samples) override;
+    
+    [[nodiscard]] std::unique_ptr<AudioStreamReader> openReader(const std::string& filePath) const override;
+    
+    [[nodiscard]] const SampleBuffer& getSamples() const override { 
+        return samples_; 
+    }
+    
+    [[nodiscard]] SampleBuffer takeSamples() override {
+        return std::exchange(samples_, SampleBuffer());
+    }
+    
+    [[nodiscard]] float getDuration() const noexcept override { 
+        return duration_; 
+    }
+    
+    [[nodiscard]] int getSampleRate() const noexcept override { 
+        return sampleRate_; 
+    }
+    
+    [[nodiscard]] int getChannels() const noexcept override { 
+        return channels_; 
+    }
+    
+    void setFormat(int sampleRate, int channels) override {
+        sampleRate_ = sampleRate;
+        channels_ = channels;
+    }
+    
+    // Checks the first bytes for a RIFF, RF64 or BW64 WAVE header.
+    [[nodiscard]] static bool isWavFile(const std::string& filePath);
+    
+private:
+    SampleBuffer samples_;
+    float duration_ = 0.0f;
+    int sampleRate_ = audio::kDefaultSampleRate;
+    int channels_ = audio::kDefaultChannels;
+    std::shared_ptr<ILogger> logger_;
+};
+
+// Streams 32-bit float WAV to disk block by block. The header goes out with
+// placeholder sizes and finish() rewrites it, switching to RF64 past 4 GB.
+class WavWriter {
+public:
+    explicit WavWriter(std::shared_ptr<ILogger> logger);
+    // Writes to a temporary file beside the target; finish() renames it into
+    // place and an unfinished one is removed.
+    ~WavWriter();
+    
+    WavWriter(const WavWriter&) = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+    
+    [[nodiscard]] bool open(const std::string& filePath, int sampleRate, int channels);
+    
+    // Accepts any number of interleaved samples; a trailing partial frame is dropped.
+    [[nodiscard]] bool write(const float* samples, size_t count);
+    
+    [[nodiscard]] bool finish();
+    
+    [[nodiscard]] bool isOpen() const noexcept { return file_ != nullptr; }
+    
+private:
+    [[nodiscard]] bool writeBytes(const void* data, size_t bytes);
+    
+    std::shared_ptr<ILogger> logger_;
+    FILE* file_ = nullptr;
+    std::string filePath_;
+    std::string temporaryPath_;
+    int sampleRate_ = 0;
+    int channels_ = 0;
+    uint64_t frames_ = 0;
+};
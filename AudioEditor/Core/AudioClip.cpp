@@ -1,7 +1,10 @@
 #include "AudioClip.h"
 #include "Adapters/Mp3.h"
+#include "Adapters/Wav.h"
 #include "Effects/Normalize.h"
+#include "Services/PcmCache.h"
 #include <algorithm>
+#include <cctype>
 #include <cmath>
 #include <numeric>
 
@@ -9,10 +12,44 @@ AudioClip::AudioClip(const std::string& filePath, std::shared_ptr<ILogger> logge
     : filePath_(filePath)
     , logger_(std::move(logger))
 {
-    audioFile_ = std::make_unique<Mp3Adapter>(logger_);
+    audioFile_ = createAdapter(filePath_);
+}
+
+std::unique_ptr<AudioFileAdapter> AudioClip::createAdapter(const std::string& filePath) const {
+    if (WavAdapter::isWavFile(filePath)) {
+        return std::make_unique<WavAdapter>(logger_);
+    }
+    return std::make_unique<Mp3Adapter>(logger_);
+}
+
+bool AudioClip::hasWavExtension(const std::string& filePath) {
+    const size_t dot = filePath.find_last_of('.');
+    if (dot == std::string::npos) return false;
+    
+    std::string extension = filePath.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == "wav";
+}
+
+bool AudioClip::isWavSource() const {
+    return dynamic_cast<WavAdapter*>(audioFile_.get()) != nullptr;
 }
 
 bool AudioClip::load() {
+    if (loadFromPcmCache()) {
+        return true;
+    }
+    
+    if (!decode()) {
+        return false;
+    }
+    
+    storeInPcmCache();
+    return true;
+}
+
+bool AudioClip::decode() {
     if (!audioFile_->load(filePath_)) {
         if (logger_) {
             logger_->error("Failed to load file: " + filePath_);
@@ -20,7 +57,7 @@ bool AudioClip::load() {
         return false;
     }
 
-    samples_ = std::vector<float>(audioFile_->getSamples());
+    replaceSamples(audioFile_->takeSamples());
     isLoaded_ = true;
     
     if (logger_) {
@@ -31,7 +68,28 @@ bool AudioClip::load() {
     return true;
 }
 
+bool AudioClip::loadFromPcmCache() {
+    if (!pcmCache_ || isWavSource()) return false;
+    
+    SampleBuffer samples;
+    int sampleRate = 0;
+    int channels = 0;
+    if (!pcmCache_->load(filePath_, samples, sampleRate, channels)) {
+        return false;
+    }
+    
+    adoptSamples(std::move(samples), sampleRate, channels);
+    return true;
+}
+
+void AudioClip::storeInPcmCache() {
+    if (!pcmCache_ || isWavSource() || samples_.empty()) return;
+    
+    pcmCache_->store(filePath_, samples_, audioFile_->getSampleRate(), audioFile_->getChannels());
+}
+
 bool AudioClip::save(const std::string& outputPath) {
+    syncSamples();
     if (!isLoaded_ || samples_.empty()) {
         if (logger_) {
             logger_->error("Cannot save: no samples loaded");
@@ -50,7 +108,18 @@ bool AudioClip::save(const std::string& outputPath) {
                      ", RMS: " + std::to_string(rms));
     }
 
-    return audioFile_->save(outputPath, samples_);
+    // The output extension picks the container, independent of the source format.
+    const bool sourceIsWav = isWavSource();
+    if (hasWavExtension(outputPath) == sourceIsWav) {
+        return audioFile_->save(outputPath, samples_);
+    }
+    
+    std::unique_ptr<AudioFileAdapter> writer = sourceIsWav
+        ? std::unique_ptr<AudioFileAdapter>(std::make_unique<Mp3Adapter>(logger_))
+        : std::unique_ptr<AudioFileAdapter>(std::make_unique<WavAdapter>(logger_));
+    writer->setFormat(audioFile_->getSampleRate(), audioFile_->getChannels());
+    writer->setEncodeThreads(encodeThreads_);
+    return writer->save(outputPath, samples_);
 }
 
 void AudioClip::addEffect(std::shared_ptr<IEffect> effect) {
@@ -60,7 +129,9 @@ void AudioClip::addEffect(std::shared_ptr<IEffect> effect) {
 }
 
 void AudioClip::applyEffects() {
+    syncSamples();
     if (!isLoaded_ || samples_.empty()) return;
+    editsCurrent_ = false;
 
     const double sumSquaresBefore = std::accumulate(samples_.begin(), samples_.end(), 0.0,
         [](double acc, float s) { return acc + s * s; });
@@ -72,12 +143,12 @@ void AudioClip::applyEffects() {
 
     for (auto& effect : effects_) {
         if (effect) {
-            effect->apply(samples_);
+            effect->apply(samples_.mutableSamples());
         }
     }
 
     auto normalizer = std::make_shared<NormalizeEffect>(logger_, static_cast<float>(rmsBefore));
-    normalizer->apply(samples_);
+    normalizer->apply(samples_.mutableSamples());
 
     if (logger_) {
         const double sumSquaresAfter = std::accumulate(samples_.begin(), samples_.end(), 0.0,
@@ -88,9 +159,60 @@ void AudioClip::applyEffects() {
 }
 
 void AudioClip::setSamples(std::vector<float> samples) {
-    samples_ = std::move(samples);
+    setSamples(SampleBuffer(std::move(samples)));
+}
+
+void AudioClip::setSamples(SampleBuffer samples) {
+    replaceSamples(std::move(samples));
     
     if (logger_) {
         logger_->log("Samples updated: " + std::to_string(samples_.size()) + " samples");
     }
 }
+
+void AudioClip::adoptSamples(SampleBuffer samples, int sampleRate, int channels) {
+    audioFile_->setFormat(sampleRate, channels);
+    replaceSamples(std::move(samples));
+    isLoaded_ = true;
+    
+    if (logger_) {
+        logger_->log("Loaded " + std::to_string(samples_.size()) + 
+                     " samples from " + filePath_);
+    }
+}
+
+void AudioClip::replaceSamples(SampleBuffer samples) {
+    samples_ = std::move(samples);
+    samplesCurrent_ = true;
+    editsCurrent_ = false;
+    edits_ = EditList();
+}
+
+void AudioClip::syncSamples() const {
+    if (samplesCurrent_) return;
+    
+    samples_ = edits_.render();
+    samplesCurrent_ = true;
+}
+
+const EditList& AudioClip::getEditList() const {
+    if (!editsCurrent_) {
+        edits_ = EditList(samples_, audioFile_->getChannels());
+        editsCurrent_ = true;
+    }
+    return edits_;
+}
+
+EditList& AudioClip::edits() {
+    (void)getEditList();
+    samplesCurrent_ = false;
+    samples_.clear();
+    return edits_;
+}
+
+void AudioClip::setEditList(EditList edits) {
+    edits_ = std::move(edits);
+    editsCurrent_ = true;
+    samplesCurrent_ = false;
+    samples_.clear();
+}
@@ -3,10 +3,14 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include "SampleBuffer.h"
+#include "EditList.h"
 #include "Adapters/AudioFileAdapter.h"
 #include "Effects/IEffect.h"
 #include "Logging/ILogger.h"
 
+class PcmCache;
+
 class AudioClip {
 public:
     explicit AudioClip(const std::string& filePath, std::shared_ptr<ILogger> logger);
@@ -18,25 +22,76 @@ public:
     AudioClip(AudioClip&&) = default;
     AudioClip& operator=(AudioClip&&) = default;
     [[nodiscard]] bool load();
+    // With a cache, load() maps compressed sources' PCM from it when it has
+    // seen the file before and stores the decode when it has not.
+    void setPcmCache(std::shared_ptr<PcmCache> cache) { pcmCache_ = std::move(cache); }
+    // The cache half of load(): false on a miss or for WAV sources, which
+    // are mapped in place anyway.
+    [[nodiscard]] bool loadFromPcmCache();
+    // The decode half: reads the file itself and leaves the cache alone.
+    [[nodiscard]] bool decode();
+    void storeInPcmCache();
+    void setDecodeThreads(unsigned threads) { audioFile_->setDecodeThreads(threads); }
+    void setDecodeCallback(AudioFileAdapter::DecodeCallback callback) {
+        audioFile_->setDecodeCallback(std::move(callback));
+    }
+    void setEncodeThreads(unsigned threads) {
+        encodeThreads_ = threads;
+        audioFile_->setEncodeThreads(threads);
+    }
     [[nodiscard]] bool save(const std::string& outputPath);
     void addEffect(std::shared_ptr<IEffect> effect);
     void applyEffects();
     void clearEffects() noexcept { effects_.clear(); }
-    [[nodiscard]] const std::vector<float>& getSamples() const noexcept { 
+    // Flattens pending edits on first use after an edit.
+    [[nodiscard]] const SampleBuffer& getSamples() const { 
+        syncSamples();
         return samples_; 
     }
-    [[nodiscard]] std::vector<float>& getSamplesRef() noexcept { 
-        return samples_; 
+    [[nodiscard]] std::vector<float>& getSamplesRef() { 
+        syncSamples();
+        editsCurrent_ = false;
+        return samples_.mutableSamples(); 
     }
+    // The clip as pieces of immutable buffers. Cut, paste, trim and silence
+    // made through edits() copy no samples; getSamples() flattens the result
+    // only when something needs one contiguous buffer.
+    [[nodiscard]] const EditList& getEditList() const;
+    [[nodiscard]] EditList& edits();
+    void setEditList(EditList edits);
     void setSamples(std::vector<float> samples);
+    void setSamples(SampleBuffer samples);
+    // Installs samples decoded outside load() and marks the clip loaded.
+    void adoptSamples(SampleBuffer samples, int sampleRate, int channels);
+    [[nodiscard]] std::unique_ptr<AudioStreamReader> openReader() const {
+        return audioFile_->openReader(filePath_);
+    }
+    [[nodiscard]] int getSampleRate() const noexcept { return audioFile_->getSampleRate(); }
+    [[nodiscard]] int getChannels() const noexcept { return audioFile_->getChannels(); }
     [[nodiscard]] bool isLoaded() const noexcept { return isLoaded_; }
     [[nodiscard]] const std::string& getFilePath() const noexcept { return filePath_; }
 
+    // Output containers are chosen by extension: WAV for .wav, MP3 otherwise.
+    [[nodiscard]] static bool hasWavExtension(const std::string& filePath);
+
 private:
+    // Sniffs the header: WAV for RIFF/RF64/BW64 WAVE files, MP3 otherwise.
+    [[nodiscard]] std::unique_ptr<AudioFileAdapter> createAdapter(const std::string& filePath) const;
+    [[nodiscard]] bool isWavSource() const;
+    void syncSamples() const;
+    void replaceSamples(SampleBuffer samples);
+
     std::string filePath_;
     std::unique_ptr<AudioFileAdapter> audioFile_;
-    std::vector<float> samples_;
+    // At least one of samples_ and edits_ is current; the other is rebuilt
+    // from it on demand.
+    mutable SampleBuffer samples_;
+    mutable EditList edits_;
+    mutable bool samplesCurrent_ = true;
+    mutable bool editsCurrent_ = false;
     std::vector<std::shared_ptr<IEffect>> effects_;
     bool isLoaded_ = false;
+    unsigned encodeThreads_ = 1;
+    std::shared_ptr<PcmCache> pcmCache_;
     std::shared_ptr<ILogger> logger_;
 };
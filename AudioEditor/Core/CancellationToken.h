@@ -0,0 +1,20 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+// Shared cancel flag. Copies refer to the same flag, so the GUI thread can keep
+// one copy and hand another to a background render that polls it between blocks.
+class CancellationToken {
+public:
+    CancellationToken() : cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() noexcept { cancelled_->store(true, std::memory_order_relaxed); }
+
+    [[nodiscard]] bool isCancelled() const noexcept {
+        return cancelled_->load(std::memory_order_relaxed);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled_;
+};
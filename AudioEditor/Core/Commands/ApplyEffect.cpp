@@ -1,6 +1,6 @@
 #include "ApplyEffect.h"
-#include "../Effects/Reverb.h"
-#include "../Effects/Speed.h"
+#include <algorithm>
+#include <filesystem>
 
 ApplyEffectCommand::ApplyEffectCommand(std::shared_ptr<AudioClip> clip,
                                        std::shared_ptr<IEffect> effect,
@@ -24,6 +24,18 @@ ApplyEffectCommand::ApplyEffectCommand(std::shared_ptr<AudioClip> clip,
 {
 }
 
+std::vector<float> ApplyEffectCommand::render(const SampleBuffer& input) const {
+    std::vector<float> samples = input.toVector();
+    
+    for (const auto& effect : effects_) {
+        if (effect) {
+            effect->apply(samples);
+        }
+    }
+    
+    return samples;
+}
+
 void ApplyEffectCommand::execute() {
     if (!clip_ || !clip_->isLoaded()) {
         if (logger_) {
@@ -32,41 +44,61 @@ void ApplyEffectCommand::execute() {
         return;
     }
     
+    const SampleBuffer before = clip_->getSamples();
+    
     if (!executed_) {
-        beforeState_ = clip_->getSamples();
-        
-        if (beforeState_.empty()) {
+        if (before.empty()) {
             if (logger_) {
                 logger_->warning("ApplyEffectCommand: Empty sample buffer");
             }
             return;
         }
         
-        std::vector<float> samples = beforeState_;
-        
+        parameters_.clear();
         for (const auto& effect : effects_) {
-            if (!effect) continue;
-            
-            if (auto* reverb = dynamic_cast<Reverb*>(effect.get())) {
-                reverb->reset();
-            }
-            
-            effect->apply(samples);
+            parameters_.push_back(effect ? effect->getParameters() : std::map<std::string, float>());
         }
         
-        clip_->setSamples(samples);
-        afterState_ = samples;
+        const SampleBuffer after(render(before));
+        afterId_ = after.id();
+        {
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            before_ = before;
+            after_ = after;
+            undoDelta_ = SampleDelta();
+            channels_ = static_cast<size_t>(std::max(1, clip_->getChannels()));
+        }
+        clip_->setSamples(after);
         executed_ = true;
         
         if (logger_) {
-            logger_->log("Effects applied and state saved for undo");
+            logger_->log("Effects applied to " + std::to_string(before.size()) + " samples");
         }
-    } else {
-        clip_->setSamples(afterState_);
-        
-        if (logger_) {
-            logger_->log("Effects re-applied (redo)");
+        return;
+    }
+    
+    SampleBuffer after;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        after = after_;
+    }
+    
+    if (after.empty()) {
+        // Compacted: re-render. The effects may have been retuned since;
+        // redo must reproduce the exact result the undo delta was taken
+        // against, and so keeps its id.
+        for (size_t i = 0; i < effects_.size(); ++i) {
+            if (!effects_[i]) continue;
+            for (const auto& [name, value] : parameters_[i]) {
+                effects_[i]->setParameter(name, value);
+            }
         }
+        after = SampleBuffer(render(before), afterId_);
+    }
+    clip_->setSamples(std::move(after));
+    
+    if (logger_) {
+        logger_->log("Effects re-applied (redo)");
     }
 }
 
@@ -78,10 +110,73 @@ void ApplyEffectCommand::undo() {
         return;
     }
     
-    clip_->setSamples(beforeState_);
+    if (!executed_) {
+        return;
+    }
+    
+    SampleBuffer before;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        before = before_;
+        if (before.empty() && !undoDelta_.applyTo(clip_->getSamples(), before)) {
+            if (logger_) {
+                logger_->error("ApplyEffectCommand: Could not restore compressed undo state");
+            }
+            return;
+        }
+    }
+    clip_->setSamples(std::move(before));
     
     if (logger_) {
         logger_->log("Effects undone - restored " + 
-                     std::to_string(beforeState_.size()) + " samples");
+                     std::to_string(clip_->getSamples().size()) + " samples");
+    }
+}
+
+size_t ApplyEffectCommand::memoryBytes() const {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    // Each holder of a shared buffer is charged its share, so a buffer the
+    // clip or a neighbouring command also holds is not counted twice.
+    size_t held = 0;
+    for (const SampleBuffer* buffer : {&before_, &after_}) {
+        if (const long owners = buffer->useCount(); owners > 0) {
+            held += buffer->size() * sizeof(float) / static_cast<size_t>(owners);
+        }
+    }
+    return undoDelta_.residentBytes() + held;
+}
+
+bool ApplyEffectCommand::compact() {
+    SampleBuffer before;
+    SampleBuffer after;
+    size_t channels = 1;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        if (before_.empty()) {
+            return true;
+        }
+        before = before_;
+        after = after_;
+        channels = channels_;
+    }
+    
+    // Built unlocked so undo and redo meanwhile still swap the held buffers.
+    SampleDelta delta = SampleDelta::between(after, before);
+    std::error_code ec;
+    const std::string directory = std::filesystem::temp_directory_path(ec).string();
+    if (ec || !delta.spill(directory, channels)) {
+        return false;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        undoDelta_ = std::move(delta);
+        before_ = SampleBuffer();
+        after_ = SampleBuffer();
+    }
+    
+    if (logger_) {
+        logger_->log("Undo state for \"" + getDescription() + "\" compressed to disk");
     }
+    return true;
 }
@@ -1,12 +1,21 @@
 #pragma once
 
 #include "ICommand.h"
+#include "SampleDelta.h"
 #include "../AudioClip.h"
 #include "../Effects/IEffect.h"
 #include "../Logging/ILogger.h"
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
+// Holds the prior and the rendered buffer by reference, so undo and redo swap
+// them in without copying or re-rendering. Under memory pressure compact()
+// trades both for the blocks that differ, compressed into a mapped temporary
+// file; undo then patches those back in and redo re-runs the effects with the
+// parameters they had on the first execute().
 class ApplyEffectCommand : public ICommand {
 public:
     ApplyEffectCommand(std::shared_ptr<AudioClip> clip, 
@@ -23,12 +32,24 @@ public:
     [[nodiscard]] std::string getDescription() const override { 
         return "Apply Effect"; 
     }
+    
+    [[nodiscard]] size_t memoryBytes() const override;
+    bool compact() override;
 
 private:
+    [[nodiscard]] std::vector<float> render(const SampleBuffer& input) const;
+
     std::shared_ptr<AudioClip> clip_;
     std::vector<std::shared_ptr<IEffect>> effects_;
+    std::vector<std::map<std::string, float>> parameters_;
     std::shared_ptr<ILogger> logger_;
-    std::vector<float> beforeState_;
-    std::vector<float> afterState_;
+    // Both empty once compact() has replaced them with undoDelta_.
+    SampleBuffer before_;
+    SampleBuffer after_;
+    SampleDelta undoDelta_;
+    uint64_t afterId_ = 0;
+    size_t channels_ = 1;
+    // Guards the undo state against compact() on the history's worker thread.
+    mutable std::mutex stateMutex_;
     bool executed_;
 };
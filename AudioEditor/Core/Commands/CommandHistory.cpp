@@ -1,9 +1,14 @@
 #include "CommandHistory.h"
+#include "../Constants.h"
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
 
 CommandHistory::CommandHistory(std::shared_ptr<ILogger> logger) 
     : logger_(std::move(logger))
     , currentIndex_(-1)
+    , memoryBudget_(audio::undo::kDefaultMemoryBudgetMb * 1024 * 1024)
+    , mergeWindow_(audio::undo::kMergeWindowMs)
 {
 }
 
@@ -22,12 +27,24 @@ void CommandHistory::executeCommand(std::shared_ptr<ICommand> command) {
         
         command->execute();
         
+        if (mergeIntoTop(*command)) {
+            lastExecuted_ = std::chrono::steady_clock::now();
+            if (logger_) {
+                logger_->log("Command merged into previous, history size: " + 
+                             std::to_string(history_.size()));
+            }
+            return;
+        }
+        
         history_.push_back(std::move(command));
         ++currentIndex_;
+        lastExecuted_ = std::chrono::steady_clock::now();
         
         if (logger_) {
             logger_->log("Command executed, history size: " + std::to_string(history_.size()));
         }
+        
+        enforceMemoryBudget();
     } catch (const std::exception& e) {
         if (logger_) {
             logger_->error("CommandHistory: Command execution failed - " + std::string(e.what()));
@@ -44,6 +61,8 @@ void CommandHistory::undo() {
         return;
     }
     
+    lastExecuted_ = {};
+    
     try {
         history_[currentIndex_]->undo();
         --currentIndex_;
@@ -67,6 +86,8 @@ void CommandHistory::redo() {
         return;
     }
     
+    lastExecuted_ = {};
+    
     try {
         ++currentIndex_;
         history_[currentIndex_]->redo();
@@ -94,6 +115,7 @@ bool CommandHistory::canRedo() const noexcept {
 void CommandHistory::clear() noexcept {
     history_.clear();
     currentIndex_ = -1;
+    lastExecuted_ = {};
     
     if (logger_) {
         logger_->log("CommandHistory: History cleared");
@@ -113,3 +135,68 @@ std::string CommandHistory::getRedoDescription() const {
     }
     return history_[currentIndex_ + 1]->getDescription();
 }
+
+bool CommandHistory::mergeIntoTop(const ICommand& command) {
+    if (currentIndex_ < 0 || mergeWindow_.count() == 0 ||
+        lastExecuted_ == std::chrono::steady_clock::time_point{}) {
+        return false;
+    }
+    
+    if (std::chrono::steady_clock::now() - lastExecuted_ > mergeWindow_) {
+        return false;
+    }
+    
+    return history_[currentIndex_]->mergeWith(command);
+}
+
+size_t CommandHistory::memoryBytes() const {
+    size_t total = 0;
+    for (const auto& command : history_) {
+        total += command->memoryBytes();
+    }
+    return total;
+}
+
+void CommandHistory::enforceMemoryBudget() {
+    if (memoryBudget_ == 0) {
+        return;
+    }
+    
+    // One pass at a time; the next command checks the budget again.
+    if (compaction_.valid() &&
+        compaction_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    
+    const size_t total = memoryBytes();
+    if (total <= memoryBudget_) {
+        return;
+    }
+    
+    // Oldest first, and the command the next undo needs last.
+    std::vector<std::shared_ptr<ICommand>> candidates;
+    for (int i = 0; i < static_cast<int>(history_.size()); ++i) {
+        if (i != currentIndex_) candidates.push_back(history_[i]);
+    }
+    if (currentIndex_ >= 0) {
+        candidates.push_back(history_[currentIndex_]);
+    }
+    
+    compaction_ = std::async(std::launch::async,
+        [candidates = std::move(candidates), logger = logger_, budget = memoryBudget_, total]() {
+            size_t remaining = total;
+            for (const auto& command : candidates) {
+                if (remaining <= budget) break;
+                
+                const size_t before = command->memoryBytes();
+                if (before == 0) continue;
+                
+                if (command->compact()) {
+                    remaining -= std::min(remaining, before - std::min(before, command->memoryBytes()));
+                } else if (logger) {
+                    logger->warning("CommandHistory: Could not compress undo state for \"" +
+                                    command->getDescription() + "\"");
+                }
+            }
+        });
+}
@@ -2,10 +2,17 @@
 
 #include "ICommand.h"
 #include "../Logging/ILogger.h"
+#include <chrono>
+#include <cstddef>
+#include <future>
 #include <memory>
 #include <vector>
 #include <string>
 
+// Undo state beyond the memory budget is compressed and spilled to disk on a
+// background thread, oldest commands first; commands restore it on undo.
+// A command executed within the merge window of the previous one is offered
+// to it through ICommand::mergeWith().
 class CommandHistory {
 public:
     explicit CommandHistory(std::shared_ptr<ILogger> logger);
@@ -31,8 +38,24 @@ public:
     [[nodiscard]] std::string getUndoDescription() const;
     [[nodiscard]] std::string getRedoDescription() const;
     
+    // 0 keeps every command's undo state in memory.
+    void setMemoryBudget(size_t bytes) noexcept { memoryBudget_ = bytes; }
+    [[nodiscard]] size_t memoryBudget() const noexcept { return memoryBudget_; }
+    [[nodiscard]] size_t memoryBytes() const;
+    
+    // Zero disables merging.
+    void setMergeWindow(std::chrono::milliseconds window) noexcept { mergeWindow_ = window; }
+    
 private:
+    void enforceMemoryBudget();
+    [[nodiscard]] bool mergeIntoTop(const ICommand& command);
+    
     std::vector<std::shared_ptr<ICommand>> history_;
     std::shared_ptr<ILogger> logger_;
     int currentIndex_;
+    size_t memoryBudget_;
+    std::future<void> compaction_;
+    std::chrono::milliseconds mergeWindow_;
+    // Empty once undo, redo or clear breaks the run of mergeable commands.
+    std::chrono::steady_clock::time_point lastExecuted_;
 };
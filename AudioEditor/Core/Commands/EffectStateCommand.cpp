@@ -1,5 +1,44 @@
 #include "EffectStateCommand.h"
 #include "../../GUI/EffectsPanel.h"
+#include <QSet>
+
+namespace {
+
+bool sameLayout(const EffectsPanelState& a, const EffectsPanelState& b) {
+    if (a.effects.size() != b.effects.size()) return false;
+    
+    for (size_t i = 0; i < a.effects.size(); ++i) {
+        if (a.effects[i].effectType != b.effects[i].effectType) return false;
+    }
+    return true;
+}
+
+// "<effect index>/<parameter>" for every parameter that differs; an empty
+// parameter name stands for the effect's enabled flag, "*" for the panel's.
+QSet<QString> changedKeys(const EffectsPanelState& from, const EffectsPanelState& to) {
+    QSet<QString> keys;
+    if (from.effectsEnabled != to.effectsEnabled) {
+        keys.insert("*");
+    }
+    
+    for (size_t i = 0; i < from.effects.size(); ++i) {
+        const EffectState& before = from.effects[i];
+        const EffectState& after = to.effects[i];
+        const QString prefix = QString::number(static_cast<int>(i)) + "/";
+        
+        if (before.enabled != after.enabled) {
+            keys.insert(prefix);
+        }
+        for (auto it = after.parameters.constBegin(); it != after.parameters.constEnd(); ++it) {
+            if (!before.parameters.contains(it.key()) || before.parameters.value(it.key()) != it.value()) {
+                keys.insert(prefix + it.key());
+            }
+        }
+    }
+    return keys;
+}
+
+}
 
 EffectStateCommand::EffectStateCommand(EffectsPanel* panel,
                                        EffectsPanelState oldState,
@@ -48,3 +87,27 @@ void EffectStateCommand::redo() {
     
     panel_->restoreState(newState_);
 }
+
+bool EffectStateCommand::mergeWith(const ICommand& next) {
+    const auto* other = dynamic_cast<const EffectStateCommand*>(&next);
+    if (!other || other->panel_ != panel_) {
+        return false;
+    }
+    
+    if (!sameLayout(oldState_, newState_) || !sameLayout(newState_, other->newState_)) {
+        return false;
+    }
+    
+    const QSet<QString> ours = changedKeys(oldState_, newState_);
+    const QSet<QString> theirs = changedKeys(newState_, other->newState_);
+    if (ours.isEmpty() || !ours.contains(theirs)) {
+        return false;
+    }
+    
+    newState_ = other->newState_;
+    
+    if (logger_) {
+        logger_->log("EffectStateCommand: Merged follow-up change");
+    }
+    return true;
+}
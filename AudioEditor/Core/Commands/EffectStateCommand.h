@@ -21,6 +21,10 @@ public:
     [[nodiscard]] std::string getDescription() const override {
         return "Effect Change";
     }
+    
+    // Merges a follow-up change to the same parameters of the same effects,
+    // e.g. the next step of a slider drag.
+    bool mergeWith(const ICommand& next) override;
 
 private:
     EffectsPanel* panel_;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 class ICommand {
@@ -10,4 +11,15 @@ public:
     virtual void undo() = 0;
     virtual void redo() { execute(); }
     [[nodiscard]] virtual std::string getDescription() const = 0;
+
+    // Undo state held in RAM, counted against CommandHistory's memory budget.
+    [[nodiscard]] virtual size_t memoryBytes() const { return 0; }
+
+    // Moves undo state out of RAM. Runs on a background thread, so it must be
+    // safe against a concurrent undo() or redo().
+    virtual bool compact() { return false; }
+
+    // Absorbs next, which has just executed, so both undo as one step.
+    // False keeps them as separate history entries.
+    virtual bool mergeWith(const ICommand& next) { (void)next; return false; }
 };
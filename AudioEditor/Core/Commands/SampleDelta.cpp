@@ -0,0 +1,130 @@
+#include "SampleDelta.h"
+#include "../Adapters/MappedFile.h"
+#include "../Constants.h"
+#include "../Dsp/FloatCodec.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using audio::undo::kDeltaBlockSamples;
+
+SampleDelta SampleDelta::between(const SampleBuffer& base, const SampleBuffer& target) {
+    SampleDelta delta;
+    delta.targetSize_ = target.size();
+    delta.targetId_ = target.id();
+
+    if (base.sharesStorageWith(target) && base.size() == target.size()) {
+        return delta;
+    }
+
+    for (size_t offset = 0; offset < target.size(); offset += kDeltaBlockSamples) {
+        const size_t count = std::min(kDeltaBlockSamples, target.size() - offset);
+        const float* changed = target.data() + offset;
+
+        // Bitwise, so -0.0f and NaN payloads survive the round trip.
+        const bool same = offset + count <= base.size() &&
+                          std::memcmp(base.data() + offset, changed, count * sizeof(float)) == 0;
+        if (same) continue;
+
+        if (delta.runs_.empty() ||
+            delta.runs_.back().offset + delta.runs_.back().count != offset) {
+            delta.runs_.push_back({offset, 0, {}, 0, 0});
+        }
+        Run& run = delta.runs_.back();
+        run.samples.insert(run.samples.end(), changed, changed + count);
+        run.count += count;
+    }
+
+    for (Run& run : delta.runs_) {
+        run.samples.shrink_to_fit();
+    }
+    return delta;
+}
+
+bool SampleDelta::applyTo(const SampleBuffer& base, SampleBuffer& target) const {
+    if (runs_.empty() && base.size() == targetSize_) {
+        target = base;
+        return true;
+    }
+
+    std::vector<float> samples(base.begin(), base.begin() + std::min(base.size(), targetSize_));
+    samples.resize(targetSize_, 0.0f);
+
+    for (const Run& run : runs_) {
+        float* destination = samples.data() + run.offset;
+        if (!spill_) {
+            std::copy(run.samples.begin(), run.samples.end(), destination);
+        } else if (!dsp::decodeFloats(spill_->data() + run.encodedOffset, run.encodedBytes,
+                                      destination, run.count, stride_)) {
+            return false;
+        }
+    }
+
+    target = SampleBuffer(std::move(samples), targetId_);
+    return true;
+}
+
+bool SampleDelta::spill(const std::string& directory, size_t stride) {
+    if (spill_ || runs_.empty()) {
+        return true;
+    }
+
+    std::vector<unsigned char> encoded;
+    std::vector<size_t> offsets;
+    for (const Run& run : runs_) {
+        offsets.push_back(encoded.size());
+        dsp::encodeFloats(run.samples.data(), run.count, stride, encoded);
+    }
+    offsets.push_back(encoded.size());
+
+    std::string path = directory + "/audioeditor-undo-XXXXXX";
+    const int fd = mkstemp(path.data());
+    if (fd < 0) {
+        return false;
+    }
+
+    FILE* file = fdopen(fd, "wb");
+    if (!file) {
+        ::close(fd);
+        std::remove(path.c_str());
+        return false;
+    }
+    const bool written = std::fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+    const bool closed = std::fclose(file) == 0;
+
+    std::string error;
+    auto mapping = written && closed ? MappedFile::open(path, error) : nullptr;
+    // The mapping keeps the data reachable; nothing is left behind on disk
+    // once it goes, even after a crash.
+    std::remove(path.c_str());
+    if (!mapping) {
+        return false;
+    }
+
+    for (size_t i = 0; i < runs_.size(); ++i) {
+        runs_[i].encodedOffset = offsets[i];
+        runs_[i].encodedBytes = offsets[i + 1] - offsets[i];
+        std::vector<float>().swap(runs_[i].samples);
+    }
+    stride_ = std::max<size_t>(1, stride);
+    spill_ = std::move(mapping);
+    return true;
+}
+
+size_t SampleDelta::residentBytes() const noexcept {
+    size_t total = runs_.capacity() * sizeof(Run);
+    for (const Run& run : runs_) {
+        total += run.samples.capacity() * sizeof(float);
+    }
+    return total;
+}
+
+size_t SampleDelta::storedSamples() const noexcept {
+    size_t total = 0;
+    for (const Run& run : runs_) {
+        total += run.count;
+    }
+    return total;
+}
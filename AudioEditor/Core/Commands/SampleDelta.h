@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../SampleBuffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class MappedFile;
+
+// The blocks of one buffer that differ from another, enough to rebuild it
+// from that other buffer. Memory grows with the edited region, not the clip.
+class SampleDelta {
+public:
+    SampleDelta() = default;
+
+    // Records the blocks of target that differ from base (or lie past its end).
+    [[nodiscard]] static SampleDelta between(const SampleBuffer& base, const SampleBuffer& target);
+
+    // Rebuilds target, id included, from the base the delta was taken
+    // against. Fails only when spilled data cannot be decoded.
+    [[nodiscard]] bool applyTo(const SampleBuffer& base, SampleBuffer& target) const;
+
+    // Compresses the changed blocks losslessly into a temporary file in
+    // directory and maps it, releasing their memory. stride is the channel
+    // count the samples are interleaved with.
+    [[nodiscard]] bool spill(const std::string& directory, size_t stride);
+
+    [[nodiscard]] bool isSpilled() const noexcept { return spill_ != nullptr; }
+
+    // Bytes held on the heap; spilled data lives in the page cache instead.
+    [[nodiscard]] size_t residentBytes() const noexcept;
+
+    [[nodiscard]] size_t storedSamples() const noexcept;
+    [[nodiscard]] size_t targetSize() const noexcept { return targetSize_; }
+
+private:
+    // A run of adjacent changed blocks. Once spilled, samples is empty and
+    // the run's encoding sits at [encodedOffset, encodedOffset + encodedBytes)
+    // of the mapping.
+    struct Run {
+        size_t offset = 0;
+        size_t count = 0;
+        std::vector<float> samples;
+        size_t encodedOffset = 0;
+        size_t encodedBytes = 0;
+    };
+
+    size_t targetSize_ = 0;
+    uint64_t targetId_ = 0;
+    size_t stride_ = 1;
+    std::vector<Run> runs_;
+    std::shared_ptr<const MappedFile> spill_;
+};
@@ -9,8 +9,16 @@ constexpr int kBitsPerSample = 16;
 constexpr float kMaxSampleValue = 32767.0f;
 constexpr float kSampleNormalizationFactor = 32768.0f;
 
-constexpr size_t kMp3ReadBufferSize = 4096;
+constexpr size_t kMp3DecodeChunkFrames = 65536;
+// Clips shorter than two segments decode and encode on one thread.
+constexpr size_t kMp3MinSegmentFrames = 1 << 20;
+// Covers the Layer III bit reservoir plus IMDCT and filterbank history.
+constexpr size_t kMp3DecodeOverlapMpegFrames = 8;
 constexpr size_t kMp3WriteBufferMultiplier = 7200;
+constexpr size_t kMp3EncodeChunkFrames = 8192;
+// Extra MPEG frames each parallel encode segment codes on both sides of its
+// range so the psychoacoustic model and MDCT have settled at the seams.
+constexpr size_t kMp3EncodeOverlapMpegFrames = 4;
 
 namespace reverb {
     constexpr int kNumCombFilters = 4;
@@ -29,6 +37,9 @@ namespace reverb {
     
     constexpr float kMinDamping = 0.15f;
     constexpr float kMaxDamping = 0.5f;
+    
+    // Must not exceed the shortest delay line, so a block never reads its own output.
+    constexpr size_t kBlockFrames = 256;
 }
 
 namespace speed {
@@ -50,6 +61,52 @@ namespace normalize {
     constexpr float kMinRMSThreshold = 0.0001f;
 }
 
+namespace render {
+    constexpr size_t kBlockFrames = 16384;
+    constexpr size_t kSegmentFrames = 131072;
+    constexpr size_t kWarmupFrames = 65536;
+    constexpr size_t kLookaheadFrames = 1024;
+    constexpr size_t kProgressGranuleFrames = 4096;
+    // Rendered blocks an export may hold between the effect chain and the encoder.
+    constexpr size_t kExportQueueBlocks = 8;
+}
+
+namespace batch {
+    // Rough decoded size of a 128 kbps MP3 as 44.1 kHz stereo float.
+    constexpr size_t kDecodedBytesPerEncodedByte = 24;
+    // Worst case for WAV input (8-bit samples widened to float).
+    constexpr size_t kDecodedBytesPerWavByte = 4;
+    // Decoded copies alive at once while loading, processing and encoding one file.
+    constexpr size_t kWorkingCopies = 5;
+    constexpr size_t kDefaultMemoryBudgetMb = 4096;
+    
+    // A parallel encode passes the benchmark when its SNR against the source
+    // is at most this far below the serial encode's and the decoded lengths agree.
+    constexpr double kEncodeBenchmarkMaxSnrLossDb = 1.0;
+    // Lag search range when aligning decoded output with the source.
+    constexpr size_t kEncodeBenchmarkMaxLagMpegFrames = 3;
+}
+
+namespace cache {
+    // Bytes hashed at each of the start, middle and end of a fingerprinted file.
+    constexpr size_t kFingerprintSampleBytes = 65536;
+    // Environment variable holding the decoded PCM cache's size cap in MB;
+    // the cache is off when it is unset or 0.
+    constexpr const char* kPcmCacheSizeVariable = "AUDIOEDITOR_PCM_CACHE_MB";
+}
+
+namespace undo {
+    // Granularity at which undo snapshots record changed samples.
+    constexpr size_t kDeltaBlockSamples = 8192;
+    // In-memory undo state kept before older snapshots are compressed to disk.
+    constexpr size_t kDefaultMemoryBudgetMb = 512;
+    // Samples sharing one Rice parameter in compressed snapshots.
+    constexpr size_t kCodecBlockSamples = 1024;
+    // Commands arriving within this long of the previous one may merge into
+    // it (one slider drag, one history entry).
+    constexpr int kMergeWindowMs = 750;
+}
+
 namespace ui {
     constexpr int kPreviewDebounceMs = 150;
     constexpr int kPositionUpdateMs = 50;
@@ -65,7 +122,16 @@ namespace waveform {
     constexpr float kZoomFactor = 1.2f;
     constexpr float kAutoScrollThreshold = 0.8f;
     constexpr float kAutoScrollPosition = 0.2f;
-    constexpr int kPeakSamplingStep = 100;
+    constexpr size_t kPeakBaseBlockFrames = 256;
+    constexpr size_t kPeakLevelFactor = 4;
+    // Frames loaded between progress reports while a file opens.
+    constexpr size_t kLoadBlockFrames = 65536;
+    // Finest pyramid level kept in the peak cache, in entries per channel
+    // (about 600 KB for two hours of stereo).
+    constexpr size_t kPeakCacheMaxLevelEntries = 1 << 16;
+    // Pyramids of earlier buffer versions the waveform keeps for undo/redo
+    // (about 30 MB each for an hour of stereo).
+    constexpr size_t kPyramidCacheEntries = 4;
     constexpr float kDisplayPadding = 0.9f;
 }
 
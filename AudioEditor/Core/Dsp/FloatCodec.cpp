@@ -0,0 +1,213 @@
+#include "FloatCodec.h"
+#include "../Constants.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+using audio::undo::kCodecBlockSamples;
+
+namespace {
+
+// Quotients this long are replaced by an escape and the raw residual.
+constexpr uint32_t kEscapeQuotient = 24;
+constexpr uint32_t kMaxRiceParameter = 31;
+
+// Monotonic in the float's value, so neighbouring samples give small deltas.
+uint32_t toOrdered(float value) noexcept {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u;
+}
+
+float fromOrdered(uint32_t ordered) noexcept {
+    const uint32_t bits = (ordered & 0x80000000u) ? ordered ^ 0x80000000u : ~ordered;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint32_t zigzag(uint32_t delta) noexcept {
+    return (delta << 1) ^ (0u - (delta >> 31));
+}
+
+uint32_t unzigzag(uint32_t value) noexcept {
+    return (value >> 1) ^ (0u - (value & 1u));
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<unsigned char>& out) : out_(out) {}
+
+    void put(uint32_t value, uint32_t bits) {
+        if (bits == 0) return;
+        buffer_ |= static_cast<uint64_t>(value & (bits == 32 ? ~0u : (1u << bits) - 1)) << count_;
+        count_ += bits;
+        while (count_ >= 8) {
+            out_.push_back(static_cast<unsigned char>(buffer_));
+            buffer_ >>= 8;
+            count_ -= 8;
+        }
+    }
+
+    void putOnes(uint32_t count) {
+        for (; count >= 16; count -= 16) put(0xffffu, 16);
+        put((1u << count) - 1, count);
+    }
+
+    void flush() {
+        if (count_ > 0) {
+            out_.push_back(static_cast<unsigned char>(buffer_));
+        }
+        buffer_ = 0;
+        count_ = 0;
+    }
+
+private:
+    std::vector<unsigned char>& out_;
+    uint64_t buffer_ = 0;
+    uint32_t count_ = 0;
+};
+
+class BitReader {
+public:
+    BitReader(const unsigned char* data, size_t size) : data_(data), end_(data + size) {}
+
+    bool get(uint32_t bits, uint32_t& value) noexcept {
+        refill();
+        if (count_ < bits) return false;
+        value = bits == 32 ? static_cast<uint32_t>(buffer_)
+                           : static_cast<uint32_t>(buffer_) & ((1u << bits) - 1);
+        consume(bits);
+        return true;
+    }
+
+    // Counts ones up to the terminating zero, which is consumed too. A run
+    // of limit ones has no terminator.
+    bool getUnary(uint32_t limit, uint32_t& ones) noexcept {
+        refill();
+        // Bits past count_ are zero, so the run never extends past them.
+        const uint64_t inverted = ~buffer_;
+        const auto run = static_cast<uint32_t>(inverted ? __builtin_ctzll(inverted) : 64);
+        
+        ones = std::min(run, limit);
+        if (ones == limit) {
+            consume(limit);
+            return true;
+        }
+        if (ones >= count_) return false;
+        consume(ones + 1);
+        return true;
+    }
+
+private:
+    void refill() noexcept {
+        while (count_ <= 56 && data_ != end_) {
+            buffer_ |= static_cast<uint64_t>(*data_++) << count_;
+            count_ += 8;
+        }
+    }
+
+    void consume(uint32_t bits) noexcept {
+        buffer_ = bits == 64 ? 0 : buffer_ >> bits;
+        count_ -= bits;
+    }
+
+    const unsigned char* data_;
+    const unsigned char* end_;
+    uint64_t buffer_ = 0;
+    uint32_t count_ = 0;
+};
+
+uint32_t riceParameter(const uint32_t* residuals, size_t count) noexcept {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += residuals[i];
+    }
+    const uint64_t mean = count > 0 ? sum / count : 0;
+
+    uint32_t k = 0;
+    while (k < kMaxRiceParameter && (uint64_t{1} << (k + 1)) <= mean) {
+        ++k;
+    }
+    return k;
+}
+
+}
+
+namespace dsp {
+
+void encodeFloats(const float* samples, size_t count, size_t stride,
+                  std::vector<unsigned char>& out) {
+    stride = std::max<size_t>(1, stride);
+    std::vector<uint32_t> previous(stride, toOrdered(0.0f));
+    std::vector<uint32_t> residuals(kCodecBlockSamples);
+    BitWriter writer(out);
+
+    for (size_t start = 0; start < count; start += kCodecBlockSamples) {
+        const size_t block = std::min(kCodecBlockSamples, count - start);
+
+        for (size_t i = 0; i < block; ++i) {
+            const size_t channel = (start + i) % stride;
+            const uint32_t ordered = toOrdered(samples[start + i]);
+            residuals[i] = zigzag(ordered - previous[channel]);
+            previous[channel] = ordered;
+        }
+
+        const uint32_t k = riceParameter(residuals.data(), block);
+        writer.put(k, 5);
+
+        for (size_t i = 0; i < block; ++i) {
+            const uint32_t quotient = residuals[i] >> k;
+            if (quotient < kEscapeQuotient) {
+                writer.putOnes(quotient);
+                writer.put(0, 1);
+                writer.put(residuals[i], k);
+            } else {
+                writer.putOnes(kEscapeQuotient);
+                writer.put(residuals[i], 32);
+            }
+        }
+    }
+    writer.flush();
+}
+
+bool decodeFloats(const unsigned char* data, size_t size,
+                  float* samples, size_t count, size_t stride) noexcept {
+    stride = std::max<size_t>(1, stride);
+    // Decoding must not allocate: one previous value per channel fits here
+    // for any realistic channel count.
+    constexpr size_t kMaxStride = 64;
+    if (stride > kMaxStride) return false;
+
+    uint32_t previous[kMaxStride];
+    std::fill(previous, previous + stride, toOrdered(0.0f));
+    BitReader reader(data, size);
+
+    for (size_t start = 0; start < count; start += kCodecBlockSamples) {
+        const size_t block = std::min(kCodecBlockSamples, count - start);
+
+        uint32_t k = 0;
+        if (!reader.get(5, k)) return false;
+
+        for (size_t i = 0; i < block; ++i) {
+            uint32_t quotient = 0;
+            uint32_t residual = 0;
+            if (!reader.getUnary(kEscapeQuotient, quotient)) return false;
+
+            if (quotient < kEscapeQuotient) {
+                uint32_t remainder = 0;
+                if (!reader.get(k, remainder)) return false;
+                residual = (quotient << k) | remainder;
+            } else if (!reader.get(32, residual)) {
+                return false;
+            }
+
+            const size_t channel = (start + i) % stride;
+            previous[channel] += unzigzag(residual);
+            samples[start + i] = fromOrdered(previous[channel]);
+        }
+    }
+    return true;
+}
+
+}
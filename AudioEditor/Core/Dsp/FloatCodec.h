@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Lossless compression of interleaved float samples. Each sample's bits are
+// mapped to an ordered integer, predicted from the previous sample of the same
+// channel, and the residual is Rice coded with a parameter chosen per block.
+// Decoding reproduces the input bit for bit, NaN payloads included.
+namespace dsp {
+
+// Appends the encoded samples to out.
+void encodeFloats(const float* samples, size_t count, size_t stride,
+                  std::vector<unsigned char>& out);
+
+// Decodes exactly count samples; false when the data is truncated or corrupt.
+[[nodiscard]] bool decodeFloats(const unsigned char* data, size_t size,
+                                float* samples, size_t count, size_t stride) noexcept;
+
+}
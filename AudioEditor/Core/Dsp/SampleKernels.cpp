@@ -0,0 +1,291 @@
+#include "SampleKernels.h"
+#include "../Constants.h"
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define AUDIO_DSP_X86 1
+#include <immintrin.h>
+#endif
+
+namespace dsp {
+
+namespace scalar {
+
+void floatToInt16(const float* src, int16_t* dst, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        const float clamped = std::clamp(src[i], -1.0f, 1.0f);
+        dst[i] = static_cast<int16_t>(clamped * audio::kMaxSampleValue);
+    }
+}
+
+void int16ToFloat(const int16_t* src, float* dst, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<float>(src[i]) / audio::kSampleNormalizationFactor;
+    }
+}
+
+void applyGain(float* samples, size_t count, float gain) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] *= gain;
+    }
+}
+
+void applyGainClamped(float* samples, size_t count, float gain) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] = std::clamp(samples[i] * gain, -1.0f, 1.0f);
+    }
+}
+
+}
+
+namespace {
+
+// Dividing by a power of two is exact, so multiplying by the reciprocal matches the scalar path.
+constexpr float kInt16ToFloat = 1.0f / audio::kSampleNormalizationFactor;
+
+#ifdef AUDIO_DSP_X86
+
+namespace sse2 {
+
+__attribute__((target("sse2")))
+void floatToInt16(const float* src, int16_t* dst, size_t count) noexcept {
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(audio::kMaxSampleValue);
+    
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi), scale);
+        const __m128 b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), lo), hi), scale);
+        const __m128i packed = _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+    }
+    scalar::floatToInt16(src + i, dst + i, count - i);
+}
+
+__attribute__((target("sse2")))
+void int16ToFloat(const int16_t* src, float* dst, size_t count) noexcept {
+    const __m128 scale = _mm_set1_ps(kInt16ToFloat);
+    
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    scalar::int16ToFloat(src + i, dst + i, count - i);
+}
+
+__attribute__((target("sse2")))
+void applyGain(float* samples, size_t count, float gain) noexcept {
+    const __m128 g = _mm_set1_ps(gain);
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), g));
+    }
+    scalar::applyGain(samples + i, count - i, gain);
+}
+
+__attribute__((target("sse2")))
+void applyGainClamped(float* samples, size_t count, float gain) noexcept {
+    const __m128 g = _mm_set1_ps(gain);
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 x = _mm_mul_ps(_mm_loadu_ps(samples + i), g);
+        _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(x, lo), hi));
+    }
+    scalar::applyGainClamped(samples + i, count - i, gain);
+}
+
+}
+
+namespace avx2 {
+
+__attribute__((target("avx2")))
+void floatToInt16(const float* src, int16_t* dst, size_t count) noexcept {
+    const __m256 lo = _mm256_set1_ps(-1.0f);
+    const __m256 hi = _mm256_set1_ps(1.0f);
+    const __m256 scale = _mm256_set1_ps(audio::kMaxSampleValue);
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256 a = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), lo), hi), scale);
+        const __m256 b = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i + 8), lo), hi), scale);
+        // packs works per 128-bit lane; the permute restores sample order.
+        const __m256i packed = _mm256_packs_epi32(_mm256_cvttps_epi32(a), _mm256_cvttps_epi32(b));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    scalar::floatToInt16(src + i, dst + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void int16ToFloat(const int16_t* src, float* dst, size_t count) noexcept {
+    const __m256 scale = _mm256_set1_ps(kInt16ToFloat);
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        const __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    scalar::int16ToFloat(src + i, dst + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void applyGain(float* samples, size_t count, float gain) noexcept {
+    const __m256 g = _mm256_set1_ps(gain);
+    
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), g));
+    }
+    scalar::applyGain(samples + i, count - i, gain);
+}
+
+__attribute__((target("avx2")))
+void applyGainClamped(float* samples, size_t count, float gain) noexcept {
+    const __m256 g = _mm256_set1_ps(gain);
+    const __m256 lo = _mm256_set1_ps(-1.0f);
+    const __m256 hi = _mm256_set1_ps(1.0f);
+    
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 x = _mm256_mul_ps(_mm256_loadu_ps(samples + i), g);
+        _mm256_storeu_ps(samples + i, _mm256_min_ps(_mm256_max_ps(x, lo), hi));
+    }
+    scalar::applyGainClamped(samples + i, count - i, gain);
+}
+
+}
+
+// GCC 12 reports the _mm512_undefined_* placeholders inside its own headers.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace avx512 {
+
+__attribute__((target("avx512f")))
+void floatToInt16(const float* src, int16_t* dst, size_t count) noexcept {
+    const __m512 lo = _mm512_set1_ps(-1.0f);
+    const __m512 hi = _mm512_set1_ps(1.0f);
+    const __m512 scale = _mm512_set1_ps(audio::kMaxSampleValue);
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512 x = _mm512_mul_ps(_mm512_min_ps(_mm512_max_ps(_mm512_loadu_ps(src + i), lo), hi), scale);
+        const __m256i packed = _mm512_cvtsepi32_epi16(_mm512_cvttps_epi32(x));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    scalar::floatToInt16(src + i, dst + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+void int16ToFloat(const int16_t* src, float* dst, size_t count) noexcept {
+    const __m512 scale = _mm512_set1_ps(kInt16ToFloat);
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512i x = _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+        _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(x), scale));
+    }
+    scalar::int16ToFloat(src + i, dst + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+void applyGain(float* samples, size_t count, float gain) noexcept {
+    const __m512 g = _mm512_set1_ps(gain);
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm512_storeu_ps(samples + i, _mm512_mul_ps(_mm512_loadu_ps(samples + i), g));
+    }
+    scalar::applyGain(samples + i, count - i, gain);
+}
+
+__attribute__((target("avx512f")))
+void applyGainClamped(float* samples, size_t count, float gain) noexcept {
+    const __m512 g = _mm512_set1_ps(gain);
+    const __m512 lo = _mm512_set1_ps(-1.0f);
+    const __m512 hi = _mm512_set1_ps(1.0f);
+    
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512 x = _mm512_mul_ps(_mm512_loadu_ps(samples + i), g);
+        _mm512_storeu_ps(samples + i, _mm512_min_ps(_mm512_max_ps(x, lo), hi));
+    }
+    scalar::applyGainClamped(samples + i, count - i, gain);
+}
+
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+struct Kernels {
+    void (*floatToInt16)(const float*, int16_t*, size_t) noexcept;
+    void (*int16ToFloat)(const int16_t*, float*, size_t) noexcept;
+    void (*applyGain)(float*, size_t, float) noexcept;
+    void (*applyGainClamped)(float*, size_t, float) noexcept;
+    const char* name;
+};
+
+Kernels selectKernels() noexcept {
+#ifdef AUDIO_DSP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return {avx512::floatToInt16, avx512::int16ToFloat,
+                avx512::applyGain, avx512::applyGainClamped, "avx512"};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return {avx2::floatToInt16, avx2::int16ToFloat,
+                avx2::applyGain, avx2::applyGainClamped, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {sse2::floatToInt16, sse2::int16ToFloat,
+                sse2::applyGain, sse2::applyGainClamped, "sse2"};
+    }
+#endif
+    return {scalar::floatToInt16, scalar::int16ToFloat,
+            scalar::applyGain, scalar::applyGainClamped, "scalar"};
+}
+
+const Kernels& kernels() noexcept {
+    static const Kernels selected = selectKernels();
+    return selected;
+}
+
+}
+
+void floatToInt16(const float* src, int16_t* dst, size_t count) noexcept {
+    kernels().floatToInt16(src, dst, count);
+}
+
+void int16ToFloat(const int16_t* src, float* dst, size_t count) noexcept {
+    kernels().int16ToFloat(src, dst, count);
+}
+
+void applyGain(float* samples, size_t count, float gain) noexcept {
+    kernels().applyGain(samples, count, gain);
+}
+
+void applyGainClamped(float* samples, size_t count, float gain) noexcept {
+    kernels().applyGainClamped(samples, count, gain);
+}
+
+const char* activeInstructionSet() noexcept {
+    return kernels().name;
+}
+
+}
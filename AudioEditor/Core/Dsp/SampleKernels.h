@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized sample loops shared by playback, file I/O and gain effects.
+// The best instruction set is picked once at first use; for finite input every
+// variant matches the scalar reference bit for bit.
+namespace dsp {
+
+// Clamps to [-1, 1], scales by audio::kMaxSampleValue and truncates.
+void floatToInt16(const float* src, int16_t* dst, size_t count) noexcept;
+
+// Scales by 1 / audio::kSampleNormalizationFactor.
+void int16ToFloat(const int16_t* src, float* dst, size_t count) noexcept;
+
+void applyGain(float* samples, size_t count, float gain) noexcept;
+
+// Multiplies by gain, then clamps to [-1, 1].
+void applyGainClamped(float* samples, size_t count, float gain) noexcept;
+
+// "avx512", "avx2", "sse2" or "scalar".
+[[nodiscard]] const char* activeInstructionSet() noexcept;
+
+namespace scalar {
+    void floatToInt16(const float* src, int16_t* dst, size_t count) noexcept;
+    void int16ToFloat(const int16_t* src, float* dst, size_t count) noexcept;
+    void applyGain(float* samples, size_t count, float gain) noexcept;
+    void applyGainClamped(float* samples, size_t count, float gain) noexcept;
+}
+
+}
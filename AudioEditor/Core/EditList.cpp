@@ -0,0 +1,203 @@
+#include "EditList.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// Streams an EditList snapshot; the pieces keep their sources alive.
+class EditListReader : public AudioStreamReader {
+public:
+    EditListReader(EditList edits, int sampleRate)
+        : edits_(std::move(edits)), sampleRate_(sampleRate) {}
+
+    [[nodiscard]] int getSampleRate() const noexcept override { return sampleRate_; }
+    [[nodiscard]] int getChannels() const noexcept override { return edits_.channels(); }
+    [[nodiscard]] size_t totalFrames() const noexcept override { return edits_.frames(); }
+    [[nodiscard]] size_t position() const noexcept override { return position_; }
+
+    [[nodiscard]] size_t read(float* buffer, size_t frames) override {
+        const size_t count = edits_.read(position_, buffer, frames);
+        position_ += count;
+        return count;
+    }
+
+    [[nodiscard]] bool seek(size_t frame) override {
+        if (frame > edits_.frames()) return false;
+        position_ = frame;
+        return true;
+    }
+
+private:
+    EditList edits_;
+    int sampleRate_;
+    size_t position_ = 0;
+};
+
+}
+
+EditList::EditList(int channels)
+    : channels_(std::max(1, channels))
+{
+}
+
+EditList::EditList(const SampleBuffer& source, int channels)
+    : EditList(channels)
+{
+    const size_t frames = source.size() / static_cast<size_t>(channels_);
+    if (frames > 0) {
+        pieces_.push_back({source, 0, frames});
+    }
+    normalize();
+}
+
+size_t EditList::pieceAt(size_t frame) const {
+    // Last piece starting at or before frame.
+    const auto it = std::upper_bound(starts_.begin(), starts_.end(), frame);
+    return it == starts_.begin() ? 0 : static_cast<size_t>(std::distance(starts_.begin(), it) - 1);
+}
+
+size_t EditList::split(size_t frame) {
+    if (frame >= frames_) {
+        return pieces_.size();
+    }
+
+    const size_t index = pieceAt(frame);
+    const size_t offset = frame - starts_[index];
+    if (offset == 0) {
+        return index;
+    }
+
+    Piece tail = pieces_[index];
+    tail.firstFrame += offset;
+    tail.frames -= offset;
+    pieces_[index].frames = offset;
+
+    pieces_.insert(pieces_.begin() + static_cast<std::ptrdiff_t>(index + 1), std::move(tail));
+    starts_.insert(starts_.begin() + static_cast<std::ptrdiff_t>(index + 1), frame);
+    return index + 1;
+}
+
+void EditList::normalize() {
+    std::vector<Piece> merged;
+    merged.reserve(pieces_.size());
+
+    for (Piece& piece : pieces_) {
+        if (piece.frames == 0) continue;
+
+        if (!merged.empty()) {
+            Piece& last = merged.back();
+            const bool bothSilent = last.source.empty() && piece.source.empty();
+            const bool continues = !piece.source.empty() &&
+                                   last.source.sharesStorageWith(piece.source) &&
+                                   last.firstFrame + last.frames == piece.firstFrame;
+            if (bothSilent || continues) {
+                last.frames += piece.frames;
+                continue;
+            }
+        }
+        merged.push_back(std::move(piece));
+    }
+
+    pieces_ = std::move(merged);
+    starts_.resize(pieces_.size());
+    frames_ = 0;
+    for (size_t i = 0; i < pieces_.size(); ++i) {
+        starts_[i] = frames_;
+        frames_ += pieces_[i].frames;
+    }
+}
+
+EditList EditList::copy(size_t firstFrame, size_t frameCount) const {
+    EditList result(channels_);
+    if (firstFrame >= frames_) {
+        return result;
+    }
+    frameCount = std::min(frameCount, frames_ - firstFrame);
+
+    for (size_t i = pieceAt(firstFrame); i < pieces_.size() && frameCount > 0; ++i) {
+        const size_t offset = firstFrame - starts_[i];
+        const size_t count = std::min(frameCount, pieces_[i].frames - offset);
+        result.pieces_.push_back({pieces_[i].source, pieces_[i].firstFrame + offset, count});
+        firstFrame += count;
+        frameCount -= count;
+    }
+
+    result.normalize();
+    return result;
+}
+
+EditList EditList::cut(size_t firstFrame, size_t frameCount) {
+    EditList removed = copy(firstFrame, frameCount);
+    erase(firstFrame, frameCount);
+    return removed;
+}
+
+void EditList::erase(size_t firstFrame, size_t frameCount) {
+    if (firstFrame >= frames_ || frameCount == 0) {
+        return;
+    }
+    const size_t lastFrame = firstFrame + std::min(frameCount, frames_ - firstFrame);
+
+    const size_t first = split(firstFrame);
+    const size_t last = split(lastFrame);
+    pieces_.erase(pieces_.begin() + static_cast<std::ptrdiff_t>(first),
+                  pieces_.begin() + static_cast<std::ptrdiff_t>(last));
+    normalize();
+}
+
+void EditList::trim(size_t firstFrame, size_t frameCount) {
+    *this = copy(firstFrame, frameCount);
+}
+
+void EditList::insertSilence(size_t atFrame, size_t frameCount) {
+    EditList silence(channels_);
+    silence.pieces_.push_back({SampleBuffer(), 0, frameCount});
+    silence.normalize();
+    (void)insert(atFrame, silence);
+}
+
+bool EditList::insert(size_t atFrame, const EditList& other) {
+    if (other.channels_ != channels_) {
+        return false;
+    }
+
+    // other may be this list.
+    const std::vector<Piece> incoming = other.pieces_;
+    const size_t index = split(std::min(atFrame, frames_));
+    pieces_.insert(pieces_.begin() + static_cast<std::ptrdiff_t>(index),
+                   incoming.begin(), incoming.end());
+    normalize();
+    return true;
+}
+
+size_t EditList::read(size_t firstFrame, float* out, size_t frameCount) const {
+    const auto channels = static_cast<size_t>(channels_);
+    size_t written = 0;
+
+    visit(firstFrame, frameCount, [&](const float* data, size_t frames) {
+        float* destination = out + written * channels;
+        if (data) {
+            std::copy(data, data + frames * channels, destination);
+        } else {
+            std::fill(destination, destination + frames * channels, 0.0f);
+        }
+        written += frames;
+    });
+    return written;
+}
+
+SampleBuffer EditList::render() const {
+    const auto channels = static_cast<size_t>(channels_);
+    if (pieces_.size() == 1 && !pieces_[0].source.empty() && pieces_[0].firstFrame == 0 &&
+        pieces_[0].frames * channels == pieces_[0].source.size()) {
+        return pieces_[0].source;
+    }
+
+    std::vector<float> samples(frames_ * channels);
+    (void)read(0, samples.data(), frames_);
+    return SampleBuffer(std::move(samples));
+}
+
+std::unique_ptr<AudioStreamReader> EditList::openReader(int sampleRate) const {
+    return std::make_unique<EditListReader>(*this, sampleRate);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "SampleBuffer.h"
+#include "Adapters/AudioStreamReader.h"
+
+// Non-destructive clip content: an ordered list of pieces, each a frame range
+// of an immutable SampleBuffer or a stretch of silence. Cut, copy, paste, trim
+// and silence insertion only split and splice pieces, O(pieces) with no
+// sample copied; samples are resolved when a reader pulls them.
+class EditList {
+public:
+    EditList() = default;
+    explicit EditList(int channels);
+    EditList(const SampleBuffer& source, int channels);
+
+    [[nodiscard]] size_t frames() const noexcept { return frames_; }
+    [[nodiscard]] int channels() const noexcept { return channels_; }
+    [[nodiscard]] bool empty() const noexcept { return frames_ == 0; }
+    [[nodiscard]] size_t pieceCount() const noexcept { return pieces_.size(); }
+
+    // Ranges are clamped to the list; positions past the end mean the end.
+    [[nodiscard]] EditList copy(size_t firstFrame, size_t frameCount) const;
+    EditList cut(size_t firstFrame, size_t frameCount);
+    void erase(size_t firstFrame, size_t frameCount);
+    void trim(size_t firstFrame, size_t frameCount);
+    void insertSilence(size_t atFrame, size_t frameCount);
+
+    // Pastes other at atFrame; false when the channel counts differ.
+    [[nodiscard]] bool insert(size_t atFrame, const EditList& other);
+
+    // Calls visitor(data, frames) for each contiguous span of the range in
+    // order; data is nullptr for silence.
+    template <typename Visitor>
+    void visit(size_t firstFrame, size_t frameCount, Visitor&& visitor) const;
+
+    // Copies up to frameCount frames into out and returns how many were read.
+    size_t read(size_t firstFrame, float* out, size_t frameCount) const;
+
+    // The whole list as one buffer; no copy when it is a single full source.
+    [[nodiscard]] SampleBuffer render() const;
+
+    [[nodiscard]] std::unique_ptr<AudioStreamReader> openReader(int sampleRate) const;
+
+private:
+    // An empty source stands for silence.
+    struct Piece {
+        SampleBuffer source;
+        size_t firstFrame = 0;
+        size_t frames = 0;
+    };
+
+    // Makes a piece start at frame and returns its index (pieces_.size() at the end).
+    size_t split(size_t frame);
+    [[nodiscard]] size_t pieceAt(size_t frame) const;
+    // Merges neighbours that continue each other and recomputes starts_.
+    void normalize();
+
+    int channels_ = 1;
+    size_t frames_ = 0;
+    std::vector<Piece> pieces_;
+    std::vector<size_t> starts_;
+};
+
+template <typename Visitor>
+void EditList::visit(size_t firstFrame, size_t frameCount, Visitor&& visitor) const {
+    if (firstFrame >= frames_) return;
+    frameCount = std::min(frameCount, frames_ - firstFrame);
+
+    const auto channels = static_cast<size_t>(channels_);
+    for (size_t i = pieceAt(firstFrame); i < pieces_.size() && frameCount > 0; ++i) {
+        const Piece& piece = pieces_[i];
+        const size_t offset = firstFrame - starts_[i];
+        const size_t count = std::min(frameCount, piece.frames - offset);
+
+        visitor(piece.source.empty() ? nullptr
+                                     : piece.source.data() + (piece.firstFrame + offset) * channels,
+                count);
+        firstFrame += count;
+        frameCount -= count;
+    }
+}
@@ -0,0 +1,261 @@
+#include "EffectChainRenderer.h"
+#include "Constants.h"
+#include "Effects/Normalize.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+}
+
+EffectChainRenderer::EffectChainRenderer(std::shared_ptr<ILogger> logger)
+    : logger_(std::move(logger))
+{
+}
+
+uint64_t EffectChainRenderer::stageKey(uint64_t upstreamKey, const IEffect& effect) {
+    uint64_t hash = hashBytes(kFnvOffset, &upstreamKey, sizeof(upstreamKey));
+    
+    const std::string name = effect.getName();
+    hash = hashBytes(hash, name.data(), name.size());
+    
+    for (const auto& [param, value] : effect.getParameters()) {
+        hash = hashBytes(hash, param.data(), param.size());
+        hash = hashBytes(hash, &value, sizeof(value));
+    }
+    
+    return hash;
+}
+
+bool EffectChainRenderer::renderSegment(const Pass& pass, const SampleBuffer& input,
+                                        size_t channels, size_t firstFrame, size_t lastFrame,
+                                        size_t warmupFrames, const CancellationToken& token,
+                                        RenderProgress* progress) {
+    const size_t inputFrames = input.size() / channels;
+    const bool isLast = lastFrame == inputFrames;
+    
+    // Frames before firstFrame only rebuild effect state and are thrown away;
+    // the lookahead lets interpolating effects finish the frames up to lastFrame.
+    size_t start = firstFrame > warmupFrames ? firstFrame - warmupFrames : 0;
+    const size_t end = isLast ? inputFrames
+                              : std::min(inputFrames, lastFrame + audio::render::kLookaheadFrames);
+    
+    std::vector<float> data(input.data() + start * channels, input.data() + end * channels);
+    std::vector<float> rendered;
+    std::vector<float> block;
+    
+    for (size_t i = 0; i < pass.effects.size(); ++i) {
+        IEffect& effect = *pass.effects[i];
+        const size_t frames = data.size() / channels;
+        
+        effect.reset();
+        effect.seek(start);
+        
+        // Normalize needs the statistics of its whole input before the first block.
+        if (auto* normalize = dynamic_cast<NormalizeEffect*>(&effect)) {
+            for (size_t frame = 0; frame < frames; frame += audio::render::kBlockFrames) {
+                if (token.isCancelled()) return false;
+                
+                const size_t count = std::min(audio::render::kBlockFrames, frames - frame);
+                block.assign(data.begin() + frame * channels, data.begin() + (frame + count) * channels);
+                normalize->analyze(block);
+            }
+        }
+        
+        rendered.clear();
+        rendered.reserve(effect.getOutputFrames(frames) * channels);
+        
+        for (size_t frame = 0; frame < frames; frame += audio::render::kBlockFrames) {
+            if (token.isCancelled()) return false;
+            
+            const size_t count = std::min(audio::render::kBlockFrames, frames - frame);
+            block.assign(data.begin() + frame * channels, data.begin() + (frame + count) * channels);
+            
+            effect.process(block);
+            rendered.insert(rendered.end(), block.begin(), block.end());
+        }
+        
+        if (isLast) {
+            effect.flush(block);
+            rendered.insert(rendered.end(), block.begin(), block.end());
+        }
+        
+        const size_t renderedStart = effect.getOutputFrames(start);
+        const size_t renderedEnd = renderedStart + rendered.size() / channels;
+        const size_t keepFirst = effect.getOutputFrames(firstFrame);
+        const size_t keepLast = std::min(pass.frames[i],
+                                         isLast ? pass.frames[i] : effect.getOutputFrames(lastFrame));
+        
+        const size_t copyLast = std::min(keepLast, renderedEnd);
+        if (copyLast > keepFirst) {
+            std::copy(rendered.begin() + (keepFirst - renderedStart) * channels,
+                      rendered.begin() + (copyLast - renderedStart) * channels,
+                      pass.outputs[i] + keepFirst * channels);
+        }
+        
+        data.swap(rendered);
+        start = renderedStart;
+        firstFrame = keepFirst;
+        lastFrame = keepLast;
+    }
+    
+    if (progress) {
+        progress->markRendered(firstFrame, lastFrame);
+    }
+    
+    return true;
+}
+
+SampleBuffer EffectChainRenderer::renderPass(const SampleBuffer& source, size_t channels,
+                                             const std::vector<std::shared_ptr<IEffect>>& effects,
+                                             bool progressive, size_t priorityFrame,
+                                             const CancellationToken& token,
+                                             const PublishCallback& publish) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    SampleBuffer input = source;
+    uint64_t key = source.id();
+    size_t reused = 0;
+    Pass pass;
+    bool segmented = progressive;
+    
+    for (const auto& effect : effects) {
+        if (!effect) continue;
+        
+        key = stageKey(key, *effect);
+        
+        if (pass.effects.empty() && reused < stages_.size() && stages_[reused].key == key &&
+            (progressive || stages_[reused].exact)) {
+            input = stages_[reused].output;
+            ++reused;
+            continue;
+        }
+        
+        pass.effects.push_back(effect.get());
+        pass.keys.push_back(key);
+        
+        // A segment never sees the whole input Normalize measures.
+        if (dynamic_cast<NormalizeEffect*>(effect.get())) {
+            segmented = false;
+        }
+    }
+    
+    stages_.resize(reused);
+    
+    if (pass.effects.empty()) {
+        if (logger_) {
+            logger_->log("EffectChainRenderer: all " + std::to_string(reused) + " stages reused from cache");
+        }
+        return input;
+    }
+    
+    const size_t inputFrames = input.size() / channels;
+    
+    std::vector<SampleBuffer> outputs;
+    size_t frames = inputFrames;
+    for (IEffect* effect : pass.effects) {
+        frames = effect->getOutputFrames(frames);
+        
+        SampleBuffer output(std::vector<float>(frames * channels));
+        pass.frames.push_back(frames);
+        pass.outputs.push_back(output.mutableSamples().data());
+        outputs.push_back(std::move(output));
+    }
+    
+    std::shared_ptr<RenderProgress> progress;
+    if (progressive) {
+        progress = std::make_shared<RenderProgress>(pass.frames.back());
+        if (publish) {
+            publish(outputs.back(), progress);
+        }
+    }
+    
+    const size_t segmentFrames = segmented ? audio::render::kSegmentFrames : std::max<size_t>(inputFrames, 1);
+    const size_t segmentCount = std::max<size_t>((inputFrames + segmentFrames - 1) / segmentFrames, 1);
+    const size_t priority = std::min(priorityFrame, inputFrames);
+    
+    // Segments ahead of the priority frame are heard first; those behind it
+    // only after a seek back, so their distance counts double.
+    auto distance = [&](size_t segment) -> size_t {
+        const size_t first = segment * segmentFrames;
+        const size_t last = std::min(first + segmentFrames, inputFrames);
+        if (priority < first) return first - priority;
+        if (priority >= last) return (priority - last) * 2;
+        return 0;
+    };
+    
+    std::vector<size_t> order(segmentCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return distance(a) < distance(b); });
+    
+    // Give every stage at least kWarmupFrames of its own input, even after a speed-up.
+    double narrowest = 1.0;
+    double ratio = 1.0;
+    for (IEffect* effect : pass.effects) {
+        ratio *= effect->getOutputRatio();
+        narrowest = std::min(narrowest, ratio);
+    }
+    const size_t warmupFrames = segmented
+        ? static_cast<size_t>(std::ceil(audio::render::kWarmupFrames / narrowest))
+        : 0;
+    
+    for (const size_t segment : order) {
+        const size_t first = segment * segmentFrames;
+        const size_t last = std::min(first + segmentFrames, inputFrames);
+        
+        if (!renderSegment(pass, input, channels, first, last, warmupFrames, token, progress.get())) {
+            if (logger_) {
+                logger_->log("EffectChainRenderer: render cancelled");
+            }
+            return SampleBuffer();
+        }
+    }
+    
+    const bool exact = segmentCount == 1;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        stages_.push_back({pass.keys[i], outputs[i], exact});
+    }
+    
+    if (logger_) {
+        logger_->log("EffectChainRenderer: " + std::to_string(stages_.size()) + " stages, " +
+                     std::to_string(reused) + " reused from cache, " +
+                     std::to_string(segmentCount) + " segments");
+    }
+    
+    return outputs.back();
+}
+
+SampleBuffer EffectChainRenderer::render(const SampleBuffer& source, int channels,
+                                         const std::vector<std::shared_ptr<IEffect>>& effects,
+                                         const CancellationToken& token) {
+    return renderPass(source, static_cast<size_t>(std::max(channels, 1)), effects, false, 0,
+                      token, nullptr);
+}
+
+SampleBuffer EffectChainRenderer::renderProgressive(const SampleBuffer& source, int channels,
+                                                    const std::vector<std::shared_ptr<IEffect>>& effects,
+                                                    size_t priorityFrame,
+                                                    const CancellationToken& token,
+                                                    const PublishCallback& publish) {
+    return renderPass(source, static_cast<size_t>(std::max(channels, 1)), effects, true,
+                      priorityFrame, token, publish);
+}
+
+void EffectChainRenderer::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stages_.clear();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "SampleBuffer.h"
+#include "CancellationToken.h"
+#include "RenderProgress.h"
+#include "Effects/IEffect.h"
+#include "Logging/ILogger.h"
+
+// Renders an effect chain block by block and keeps every stage's output,
+// keyed by a hash of the source version and all parameters up to that stage.
+// Re-rendering after a parameter change only runs the changed stage and the
+// stages after it.
+class EffectChainRenderer {
+public:
+    // Receives the final buffer before it is filled in; frames become valid as
+    // progress reports them.
+    using PublishCallback = std::function<void(const SampleBuffer& output,
+                                               std::shared_ptr<const RenderProgress> progress)>;
+
+    explicit EffectChainRenderer(std::shared_ptr<ILogger> logger);
+    ~EffectChainRenderer() = default;
+
+    EffectChainRenderer(const EffectChainRenderer&) = delete;
+    EffectChainRenderer& operator=(const EffectChainRenderer&) = delete;
+
+    // Exact single pass over the whole clip of interleaved channels. Returns an
+    // empty buffer if the token is cancelled before the chain completes.
+    [[nodiscard]] SampleBuffer render(const SampleBuffer& source, int channels,
+                                      const std::vector<std::shared_ptr<IEffect>>& effects,
+                                      const CancellationToken& token = {});
+
+    // Renders in segments, nearest to priorityFrame (a source frame) first, so
+    // playback can start before the whole clip is done. Each segment starts from
+    // a warm-up window to rebuild effect state, so stateful effects may differ
+    // from render() by a decayed tail; render() does not reuse these stages.
+    [[nodiscard]] SampleBuffer renderProgressive(const SampleBuffer& source, int channels,
+                                                 const std::vector<std::shared_ptr<IEffect>>& effects,
+                                                 size_t priorityFrame,
+                                                 const CancellationToken& token,
+                                                 const PublishCallback& publish);
+
+    void clear();
+
+    [[nodiscard]] static uint64_t stageKey(uint64_t upstreamKey, const IEffect& effect);
+
+private:
+    struct Stage {
+        uint64_t key;
+        SampleBuffer output;
+        bool exact;
+    };
+
+    struct Pass {
+        std::vector<IEffect*> effects;
+        std::vector<uint64_t> keys;
+        std::vector<size_t> frames;
+        std::vector<float*> outputs;
+    };
+
+    [[nodiscard]] SampleBuffer renderPass(const SampleBuffer& source, size_t channels,
+                                          const std::vector<std::shared_ptr<IEffect>>& effects,
+                                          bool progressive, size_t priorityFrame,
+                                          const CancellationToken& token,
+                                          const PublishCallback& publish);
+
+    [[nodiscard]] static bool renderSegment(const Pass& pass, const SampleBuffer& input,
+                                            size_t channels, size_t firstFrame, size_t lastFrame,
+                                            size_t warmupFrames, const CancellationToken& token,
+                                            RenderProgress* progress);
+
+    std::mutex mutex_;
+    std::vector<Stage> stages_;
+    std::shared_ptr<ILogger> logger_;
+};
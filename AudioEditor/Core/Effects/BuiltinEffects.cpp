@@ -0,0 +1,21 @@
+#include "BuiltinEffects.h"
+#include "../EffectFactory.h"
+#include "Normalize.h"
+#include "Reverb.h"
+#include "Speed.h"
+#include "Volume.h"
+
+void registerBuiltinEffects() {
+    EffectFactory::registerEffect("Reverb", [](std::shared_ptr<ILogger> log) {
+        return std::make_shared<Reverb>(log);
+    });
+    EffectFactory::registerEffect("Speed", [](std::shared_ptr<ILogger> log) {
+        return std::make_shared<SpeedChangeEffect>(1.0f, log);
+    });
+    EffectFactory::registerEffect("Volume", [](std::shared_ptr<ILogger> log) {
+        return std::make_shared<VolumeEffect>(1.0f, log);
+    });
+    EffectFactory::registerEffect("Normalize", [](std::shared_ptr<ILogger> log) {
+        return std::make_shared<NormalizeEffect>(log);
+    });
+}
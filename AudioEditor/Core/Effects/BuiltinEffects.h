@@ -0,0 +1,5 @@
+#pragma once
+
+// Registers Reverb, Speed, Volume and Normalize with EffectFactory under
+// their getName() strings. Safe to call more than once.
+void registerBuiltinEffects();
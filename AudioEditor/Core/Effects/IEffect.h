@@ -1,5 +1,6 @@
 #pragma once
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -7,9 +8,42 @@ class IEffect {
 public:
     virtual ~IEffect() = default;
 
-    virtual void apply(std::vector<float>& audioBuffer) = 0;
+    // Processes one block of interleaved stereo frames in place. Internal state
+    // (delay lines, resampler history) carries over to the next block until
+    // reset(); effects that change the length may resize the block.
+    virtual void process(std::vector<float>& block) = 0;
+
+    // Fills tail with whatever the effect still holds back once the input has ended.
+    virtual void flush(std::vector<float>& tail) { tail.clear(); }
+
+    virtual void reset() {}
+
+    // Called after reset() when the first block fed will start at an absolute
+    // input frame other than 0 (segmented rendering). Output then starts at
+    // absolute frame getOutputFrames(inputFrame).
+    virtual void seek(size_t inputFrame) { (void)inputFrame; }
+
+    // Output length relative to input length (e.g. 0.5 for double speed).
+    [[nodiscard]] virtual double getOutputRatio() const noexcept { return 1.0; }
+
+    [[nodiscard]] virtual size_t getOutputFrames(size_t inputFrames) const noexcept {
+        return inputFrames;
+    }
+
+    // Whole-buffer convenience wrapper: one fresh pass over the entire clip.
+    virtual void apply(std::vector<float>& audioBuffer) {
+        reset();
+        process(audioBuffer);
+
+        std::vector<float> tail;
+        flush(tail);
+        audioBuffer.insert(audioBuffer.end(), tail.begin(), tail.end());
+    }
 
     virtual void setParameter(const std::string& name, float value) = 0;
 
+    // Current values under the names setParameter() accepts.
+    [[nodiscard]] virtual std::map<std::string, float> getParameters() const = 0;
+
     [[nodiscard]] virtual std::string getName() const noexcept = 0;
 };
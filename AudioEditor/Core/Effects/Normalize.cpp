@@ -1,4 +1,5 @@
 #include "Normalize.h"
+#include "../Dsp/SampleKernels.h"
 #include <cmath>
 #include <algorithm>
 #include <numeric>
@@ -18,6 +19,10 @@ void NormalizeEffect::setParameter(const std::string& name, float value) {
     }
 }
 
+std::map<std::string, float> NormalizeEffect::getParameters() const {
+    return {{"targetRMS", targetRMS_}, {"targetPeak", targetPeak_}};
+}
+
 float NormalizeEffect::calculateRMS(const std::vector<float>& buffer) {
     if (buffer.empty()) return 0.0f;
     
@@ -37,43 +42,73 @@ float NormalizeEffect::calculatePeak(const std::vector<float>& buffer) {
     return peak;
 }
 
-void NormalizeEffect::apply(std::vector<float>& buffer) {
-    if (buffer.empty()) return;
+void NormalizeEffect::reset() {
+    sumSquares_ = 0.0;
+    peak_ = 0.0f;
+    analyzedSamples_ = 0;
+}
+
+void NormalizeEffect::analyze(const std::vector<float>& block) {
+    sumSquares_ = std::accumulate(block.begin(), block.end(), sumSquares_,
+        [](double acc, float sample) { return acc + sample * sample; });
+    peak_ = std::max(peak_, calculatePeak(block));
+    analyzedSamples_ += block.size();
+}
+
+float NormalizeEffect::getRMSGain() const noexcept {
+    if (analyzedSamples_ == 0) return 1.0f;
     
-    const float currentRMS = calculateRMS(buffer);
-    const float currentPeak = calculatePeak(buffer);
+    const auto currentRMS = static_cast<float>(std::sqrt(sumSquares_ / analyzedSamples_));
+    return (currentRMS > audio::normalize::kMinRMSThreshold) 
+           ? (targetRMS_ / currentRMS) 
+           : 1.0f;
+}
+
+float NormalizeEffect::getPeakGain() const noexcept {
+    const float newPeak = peak_ * getRMSGain();
+    return (newPeak > targetPeak_) ? targetPeak_ / newPeak : 1.0f;
+}
+
+void NormalizeEffect::process(std::vector<float>& block) {
+    if (block.empty()) return;
     
-    if (logger_) {
-        logger_->log("Before normalize - RMS: " + std::to_string(currentRMS) +
-                     ", Peak: " + std::to_string(currentPeak));
+    if (analyzedSamples_ == 0) {
+        analyze(block);
     }
     
-    const float rmsGain = (currentRMS > audio::normalize::kMinRMSThreshold) 
-                         ? (targetRMS_ / currentRMS) 
-                         : 1.0f;
+    const float rmsGain = getRMSGain();
+    const float peakGain = getPeakGain();
+    
+    dsp::applyGain(block.data(), block.size(), rmsGain);
     
-    for (float& sample : buffer) {
-        sample *= rmsGain;
+    if (peakGain < 1.0f) {
+        dsp::applyGain(block.data(), block.size(), peakGain);
     }
+}
+
+void NormalizeEffect::apply(std::vector<float>& buffer) {
+    if (buffer.empty()) return;
     
-    const float newPeak = calculatePeak(buffer);
-    if (newPeak > targetPeak_) {
-        const float peakGain = targetPeak_ / newPeak;
-        for (float& sample : buffer) {
-            sample *= peakGain;
-        }
-        
-        if (logger_) {
-            logger_->log("Clipping prevented - applied limiter (gain: " +
-                         std::to_string(peakGain) + "x)");
-        }
+    reset();
+    analyze(buffer);
+    
+    if (logger_) {
+        logger_->log("Before normalize - RMS: " + std::to_string(calculateRMS(buffer)) +
+                     ", Peak: " + std::to_string(peak_));
     }
     
+    process(buffer);
+    
     if (logger_) {
+        if (getPeakGain() < 1.0f) {
+            logger_->log("Clipping prevented - applied limiter (gain: " +
+                         std::to_string(getPeakGain()) + "x)");
+        }
+        
         const float finalRMS = calculateRMS(buffer);
         const float finalPeak = calculatePeak(buffer);
         logger_->log("After normalize - RMS: " + std::to_string(finalRMS) +
                      ", Peak: " + std::to_string(finalPeak) +
-                     ", Gain applied: " + std::to_string(rmsGain));
+                     ", Gain applied: " + std::to_string(getRMSGain()));
     }
 }
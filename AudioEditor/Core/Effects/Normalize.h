@@ -11,7 +11,13 @@ public:
                             float targetRMS = audio::normalize::kDefaultTargetRMS);
     
     void apply(std::vector<float>& audioBuffer) override;
+    void process(std::vector<float>& block) override;
+    void reset() override;
+    
+    // Streaming use: feed the whole signal through analyze() before process().
+    void analyze(const std::vector<float>& block);
     void setParameter(const std::string& name, float value) override;
+    [[nodiscard]] std::map<std::string, float> getParameters() const override;
     [[nodiscard]] std::string getName() const noexcept override { return "Normalize"; }
     
     void setTargetRMS(float rms) noexcept { targetRMS_ = rms; }
@@ -23,8 +29,14 @@ public:
 private:
     [[nodiscard]] static float calculateRMS(const std::vector<float>& buffer);
     [[nodiscard]] static float calculatePeak(const std::vector<float>& buffer);
+    [[nodiscard]] float getRMSGain() const noexcept;
+    [[nodiscard]] float getPeakGain() const noexcept;
 
     std::shared_ptr<ILogger> logger_;
     float targetRMS_;
     float targetPeak_;
+    
+    double sumSquares_ = 0.0;
+    float peak_ = 0.0f;
+    size_t analyzedSamples_ = 0;
 };
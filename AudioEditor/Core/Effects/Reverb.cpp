@@ -23,6 +23,10 @@ void Reverb::setParameter(const std::string& name, float value) {
     }
 }
 
+std::map<std::string, float> Reverb::getParameters() const {
+    return {{"intensity", intensity_}};
+}
+
 void Reverb::reset() {
     for (auto& buf : combBuffersL_) std::fill(buf.begin(), buf.end(), 0.0f);
     for (auto& buf : combBuffersR_) std::fill(buf.begin(), buf.end(), 0.0f);
@@ -54,9 +58,38 @@ void Reverb::initBuffers(int sampleRate) {
 }
 
 void Reverb::apply(std::vector<float>& audioBuffer) {
+    if (logger_ && intensity_ >= 0.001f) {
+        logger_->log("Reverb: intensity=" + std::to_string(intensity_));
+    }
+    
+    IEffect::apply(audioBuffer);
+}
+
+namespace {
+
+static_assert(audio::reverb::kNumCombFilters == 4, "comb lanes are laid out for four combs");
+using CombLanes = float __attribute__((vector_size(4 * sizeof(float))));
+
+// Delay lines are at least one block long, so a block's reads and writes
+// each split into at most two contiguous runs.
+template <typename Fn>
+void forRingRuns(size_t index, size_t count, size_t size, Fn&& fn) {
+    const size_t first = std::min(count, size - index);
+    fn(index, 0, first);
+    fn(0, first, count - first);
+}
+
+size_t advanceRing(size_t index, size_t count, size_t size) {
+    index += count;
+    return index >= size ? index - size : index;
+}
+
+}
+
+void Reverb::process(std::vector<float>& block) {
     using namespace audio::reverb;
     
-    if (audioBuffer.empty() || intensity_ < 0.001f) {
+    if (block.empty() || intensity_ < 0.001f) {
         return;
     }
     
@@ -70,72 +103,107 @@ void Reverb::apply(std::vector<float>& audioBuffer) {
     const float wetMix = kMinWetMix + t * (kMaxWetMix - kMinWetMix);
     const float dryMix = 1.0f - (wetMix * 0.5f);
     
-    if (logger_) {
-        logger_->log("Reverb: intensity=" + std::to_string(intensity_) +
-                    " t=" + std::to_string(t) +
-                    " wet=" + std::to_string(wetMix));
+    const size_t numSamples = block.size() / 2;
+    
+    for (size_t i = 0; i < numSamples; i += kBlockFrames) {
+        processBlock(block.data() + i * 2, std::min(kBlockFrames, numSamples - i),
+                     feedback, damping, wetMix, dryMix);
     }
+}
+
+void Reverb::processBlock(float* frames, size_t count, float feedback, float damping,
+                          float wetMix, float dryMix) {
+    using namespace audio::reverb;
     
-    const size_t numSamples = audioBuffer.size() / 2;
+    std::array<float, kBlockFrames> input;
+    for (size_t i = 0; i < count; ++i) {
+        input[i] = (frames[i * 2] + frames[i * 2 + 1]) * 0.5f;
+    }
     
-    for (size_t i = 0; i < numSamples; ++i) {
-        float inputL = audioBuffer[i * 2];
-        float inputR = audioBuffer[i * 2 + 1];
-        float input = (inputL + inputR) * 0.5f;
-        
-        float combOutL = 0.0f;
-        float combOutR = 0.0f;
-        
+    const float undamped = 1.0f - damping;
+    std::array<float, kBlockFrames> outL;
+    std::array<float, kBlockFrames> outR;
+    
+    // Left combs carry a damping state from frame to frame, so they advance
+    // together as the four lanes of one vector. Runs are cut wherever one of
+    // the lines wraps, leaving no index arithmetic inside the frame loop.
+    const CombLanes undampedLanes = {undamped, undamped, undamped, undamped};
+    const CombLanes dampingLanes = {damping, damping, damping, damping};
+    const CombLanes feedbackLanes = {feedback, feedback, feedback, feedback};
+    CombLanes store = {combFilterStore_[0], combFilterStore_[1], combFilterStore_[2], combFilterStore_[3]};
+    
+    for (size_t done = 0; done < count;) {
+        size_t run = count - done;
+        std::array<float*, kNumCombFilters> line;
         for (int c = 0; c < kNumCombFilters; ++c) {
-            auto& bufL = combBuffersL_[c];
-            auto& bufR = combBuffersR_[c];
-            size_t& idx = combIndices_[c];
-            float& filterStore = combFilterStore_[c];
-            
-            float delayedL = bufL[idx];
-            float delayedR = bufR[idx];
-            
-            filterStore = delayedL * (1.0f - damping) + filterStore * damping;
-            
-            bufL[idx] = input + filterStore * feedback;
-            bufR[idx] = input + delayedR * (1.0f - damping) * feedback;
-            
-            combOutL += delayedL;
-            combOutR += delayedR;
-            
-            idx = (idx + 1) % bufL.size();
+            auto& buf = combBuffersL_[c];
+            const size_t pos = advanceRing(combIndices_[c], done, buf.size());
+            line[c] = buf.data() + pos;
+            run = std::min(run, buf.size() - pos);
         }
         
-        combOutL /= kNumCombFilters;
-        combOutR /= kNumCombFilters;
-        
-        float allpassOutL = combOutL;
-        float allpassOutR = combOutR;
-        
-        for (int a = 0; a < kNumAllpassFilters; ++a) {
-            auto& bufL = allpassBuffersL_[a];
-            auto& bufR = allpassBuffersR_[a];
-            size_t& idx = allpassIndices_[a];
-            
-            float delayedL = bufL[idx];
-            float delayedR = bufR[idx];
-            
-            float tempL = -kAllpassGain * allpassOutL + delayedL;
-            float tempR = -kAllpassGain * allpassOutR + delayedR;
-            
-            bufL[idx] = allpassOutL + kAllpassGain * delayedL;
-            bufR[idx] = allpassOutR + kAllpassGain * delayedR;
+        for (size_t k = 0; k < run; ++k) {
+            const CombLanes delayed = {line[0][k], line[1][k], line[2][k], line[3][k]};
+            const float x = input[done + k];
+            const CombLanes inputLanes = {x, x, x, x};
             
-            allpassOutL = tempL;
-            allpassOutR = tempR;
+            store = delayed * undampedLanes + store * dampingLanes;
+            const CombLanes fed = inputLanes + store * feedbackLanes;
             
-            idx = (idx + 1) % bufL.size();
+            for (int c = 0; c < kNumCombFilters; ++c) {
+                line[c][k] = fed[c];
+            }
+            outL[done + k] = (((0.0f + delayed[0]) + delayed[1]) + delayed[2] + delayed[3]) / kNumCombFilters;
         }
         
-        float outL = inputL * dryMix + allpassOutL * wetMix;
-        float outR = inputR * dryMix + allpassOutR * wetMix;
-        
-        audioBuffer[i * 2] = std::clamp(outL, -1.0f, 1.0f);
-        audioBuffer[i * 2 + 1] = std::clamp(outR, -1.0f, 1.0f);
+        done += run;
+    }
+    for (int c = 0; c < kNumCombFilters; ++c) {
+        combFilterStore_[c] = store[c];
+    }
+    
+    // Right combs have no state besides the line itself, so each is a plain
+    // loop over the block.
+    std::fill_n(outR.begin(), count, 0.0f);
+    for (int c = 0; c < kNumCombFilters; ++c) {
+        auto& buf = combBuffersR_[c];
+        forRingRuns(combIndices_[c], count, buf.size(), [&](size_t from, size_t to, size_t n) {
+            float* line = buf.data() + from;
+            for (size_t k = 0; k < n; ++k) {
+                const float delayed = line[k];
+                outR[to + k] += delayed;
+                line[k] = input[to + k] + delayed * undamped * feedback;
+            }
+        });
+        combIndices_[c] = advanceRing(combIndices_[c], count, buf.size());
+    }
+    for (size_t i = 0; i < count; ++i) {
+        outR[i] /= kNumCombFilters;
     }
-}
\ No newline at end of file
+    
+    // Within a block every allpass read predates every write.
+    auto allpass = [count](std::vector<float>& buf, size_t index, std::array<float, kBlockFrames>& signal) {
+        forRingRuns(index, count, buf.size(), [&](size_t from, size_t to, size_t n) {
+            float* line = buf.data() + from;
+            for (size_t k = 0; k < n; ++k) {
+                const float delayed = line[k];
+                const float x = signal[to + k];
+                line[k] = x + kAllpassGain * delayed;
+                signal[to + k] = -kAllpassGain * x + delayed;
+            }
+        });
+    };
+    
+    for (int a = 0; a < kNumAllpassFilters; ++a) {
+        allpass(allpassBuffersL_[a], allpassIndices_[a], outL);
+        allpass(allpassBuffersR_[a], allpassIndices_[a], outR);
+        allpassIndices_[a] = advanceRing(allpassIndices_[a], count, allpassBuffersL_[a].size());
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        const float wetL = frames[i * 2] * dryMix + outL[i] * wetMix;
+        const float wetR = frames[i * 2 + 1] * dryMix + outR[i] * wetMix;
+        frames[i * 2] = std::min(std::max(wetL, -1.0f), 1.0f);
+        frames[i * 2 + 1] = std::min(std::max(wetR, -1.0f), 1.0f);
+    }
+}
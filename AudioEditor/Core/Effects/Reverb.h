@@ -13,13 +13,15 @@ public:
     explicit Reverb(std::shared_ptr<ILogger> logger = nullptr);
     
     void apply(std::vector<float>& audioBuffer) override;
+    void process(std::vector<float>& block) override;
     std::string getName() const noexcept override { return "Reverb"; }
     
     void setIntensity(float intensity);
     float getIntensity() const { return intensity_; }
     void setParameter(const std::string& name, float value) override;
+    std::map<std::string, float> getParameters() const override;
     
-    void reset();
+    void reset() override;
 
 private:
     float intensity_;
@@ -36,6 +38,8 @@ private:
     
     bool initialized_;
     void initBuffers(int sampleRate);
+    void processBlock(float* frames, size_t count, float feedback, float damping,
+                      float wetMix, float dryMix);
 };
 
 #endif
\ No newline at end of file
@@ -22,6 +22,10 @@ void SpeedChangeEffect::setParameter(const std::string& name, float value) {
     }
 }
 
+std::map<std::string, float> SpeedChangeEffect::getParameters() const {
+    return {{"speed", speedFactor_}};
+}
+
 static float hermite(float y0, float y1, float y2, float y3, float t) {
     const float t2 = t * t;
     const float t3 = t2 * t;
@@ -34,58 +38,125 @@ static float hermite(float y0, float y1, float y2, float y3, float t) {
     return c0 + c1 * t + c2 * t2 + c3 * t3;
 }
 
-void SpeedChangeEffect::apply(std::vector<float>& audioBuffer) {
-    if (std::abs(speedFactor_ - 1.0f) < 0.001f || audioBuffer.empty()) {
+bool SpeedChangeEffect::isBypassed() const noexcept {
+    return std::abs(speedFactor_ - 1.0f) < 0.001f;
+}
+
+double SpeedChangeEffect::getOutputRatio() const noexcept {
+    return isBypassed() ? 1.0 : 1.0 / speedFactor_;
+}
+
+size_t SpeedChangeEffect::getOutputFrames(size_t inputFrames) const noexcept {
+    if (isBypassed()) {
+        return inputFrames;
+    }
+    const size_t outputFrames = static_cast<size_t>(static_cast<double>(inputFrames) / speedFactor_);
+    return outputFrames > 0 ? outputFrames : inputFrames;
+}
+
+void SpeedChangeEffect::reset() {
+    history_.clear();
+    historyStart_ = 0;
+    inputFrames_ = 0;
+    outputIndex_ = 0;
+}
+
+void SpeedChangeEffect::seek(size_t inputFrame) {
+    historyStart_ = inputFrame;
+    inputFrames_ = inputFrame;
+    outputIndex_ = getOutputFrames(inputFrame);
+}
+
+void SpeedChangeEffect::renderFrame(size_t outputIndex, float* out) const {
+    constexpr int channels = 2;
+    
+    const double srcPos = static_cast<double>(outputIndex) * speedFactor_;
+    const size_t srcIdx = static_cast<size_t>(srcPos);
+    const float t = static_cast<float>(srcPos - srcIdx);
+    
+    for (int ch = 0; ch < channels; ++ch) {
+        auto getSample = [&](size_t idx) -> float {
+            if (idx >= inputFrames_) idx = inputFrames_ - 1;
+            if (idx < historyStart_) idx = historyStart_;
+            return history_[(idx - historyStart_) * channels + ch];
+        };
+        
+        const size_t idx0 = (srcIdx > 0) ? srcIdx - 1 : 0;
+        const size_t idx1 = srcIdx;
+        const size_t idx2 = srcIdx + 1;
+        const size_t idx3 = srcIdx + 2;
+        
+        const float y0 = getSample(idx0);
+        const float y1 = getSample(idx1);
+        const float y2 = getSample(idx2);
+        const float y3 = getSample(idx3);
+        
+        float sample = hermite(y0, y1, y2, y3, t);
+        out[ch] = std::clamp(sample, -1.0f, 1.0f);
+    }
+}
+
+void SpeedChangeEffect::process(std::vector<float>& block) {
+    if (isBypassed() || block.empty()) {
         return;
     }
 
     constexpr int channels = 2;
     
-    if (audioBuffer.size() % channels != 0) {
+    if (block.size() % channels != 0) {
         if (logger_) {
-            logger_->warning("Odd buffer size (" + std::to_string(audioBuffer.size()) + 
+            logger_->warning("Odd buffer size (" + std::to_string(block.size()) + 
                             "), padding with silence");
         }
-        audioBuffer.push_back(0.0f);
+        block.push_back(0.0f);
     }
     
-    const size_t inputFrames = audioBuffer.size() / channels;
-    const size_t outputFrames = static_cast<size_t>(static_cast<double>(inputFrames) / speedFactor_);
+    history_.insert(history_.end(), block.begin(), block.end());
+    inputFrames_ += block.size() / channels;
+    
+    // A frame can only be interpolated once the two frames after it have arrived.
+    output_.clear();
+    while (true) {
+        const size_t srcIdx = static_cast<size_t>(static_cast<double>(outputIndex_) * speedFactor_);
+        if (srcIdx + 2 >= inputFrames_) {
+            break;
+        }
+        output_.resize(output_.size() + channels);
+        renderFrame(outputIndex_, output_.data() + output_.size() - channels);
+        ++outputIndex_;
+    }
+    
+    const size_t nextSrcIdx = static_cast<size_t>(static_cast<double>(outputIndex_) * speedFactor_);
+    const size_t keepFrom = std::min(nextSrcIdx > 0 ? nextSrcIdx - 1 : 0, inputFrames_);
+    if (keepFrom > historyStart_) {
+        history_.erase(history_.begin(), 
+                       history_.begin() + static_cast<std::ptrdiff_t>((keepFrom - historyStart_) * channels));
+        historyStart_ = keepFrom;
+    }
+    
+    block.swap(output_);
+}
+
+void SpeedChangeEffect::flush(std::vector<float>& tail) {
+    tail.clear();
+    
+    if (isBypassed() || inputFrames_ == 0) {
+        return;
+    }
+
+    constexpr int channels = 2;
+    const size_t outputFrames = static_cast<size_t>(static_cast<double>(inputFrames_) / speedFactor_);
     
     if (outputFrames == 0) {
         if (logger_) {
             logger_->warning("Speed change would produce 0 frames, skipping");
         }
+        tail = history_;
         return;
     }
     
-    std::vector<float> output(outputFrames * channels, 0.0f);
-
-    for (size_t i = 0; i < outputFrames; ++i) {
-        const double srcPos = static_cast<double>(i) * speedFactor_;
-        const size_t srcIdx = static_cast<size_t>(srcPos);
-        const float t = static_cast<float>(srcPos - srcIdx);
-        
-        for (int ch = 0; ch < channels; ++ch) {
-            auto getSample = [&](size_t idx) -> float {
-                if (idx >= inputFrames) idx = inputFrames - 1;
-                return audioBuffer[idx * channels + ch];
-            };
-            
-            const size_t idx0 = (srcIdx > 0) ? srcIdx - 1 : 0;
-            const size_t idx1 = srcIdx;
-            const size_t idx2 = srcIdx + 1;
-            const size_t idx3 = srcIdx + 2;
-            
-            const float y0 = getSample(idx0);
-            const float y1 = getSample(idx1);
-            const float y2 = getSample(idx2);
-            const float y3 = getSample(idx3);
-            
-            float sample = hermite(y0, y1, y2, y3, t);
-            output[i * channels + ch] = std::clamp(sample, -1.0f, 1.0f);
-        }
+    tail.resize((outputFrames > outputIndex_ ? outputFrames - outputIndex_ : 0) * channels);
+    for (size_t i = 0; outputIndex_ < outputFrames; ++i, ++outputIndex_) {
+        renderFrame(outputIndex_, tail.data() + i * channels);
     }
-
-    audioBuffer = std::move(output);
-}
\ No newline at end of file
+}
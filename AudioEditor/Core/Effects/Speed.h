@@ -4,19 +4,35 @@
 #include "../Logging/ILogger.h"
 #include "../Constants.h"
 #include <memory>
+#include <vector>
 
 class SpeedChangeEffect : public IEffect {
 public:
     SpeedChangeEffect(float speedFactor, std::shared_ptr<ILogger> logger);
     
-    void apply(std::vector<float>& audioBuffer) override;
+    void process(std::vector<float>& block) override;
+    void flush(std::vector<float>& tail) override;
+    void reset() override;
+    void seek(size_t inputFrame) override;
+    [[nodiscard]] double getOutputRatio() const noexcept override;
+    [[nodiscard]] size_t getOutputFrames(size_t inputFrames) const noexcept override;
     void setParameter(const std::string& name, float value) override;
+    [[nodiscard]] std::map<std::string, float> getParameters() const override;
     [[nodiscard]] std::string getName() const noexcept override { return "Speed"; }
     
     void setSpeedFactor(float speedFactor);
     [[nodiscard]] float getSpeedFactor() const noexcept { return speedFactor_; }
 
 private:
+    [[nodiscard]] bool isBypassed() const noexcept;
+    void renderFrame(size_t outputIndex, float* out) const;
+
     float speedFactor_;
     std::shared_ptr<ILogger> logger_;
+    
+    std::vector<float> history_;
+    size_t historyStart_ = 0;
+    size_t inputFrames_ = 0;
+    size_t outputIndex_ = 0;
+    std::vector<float> output_;
 };
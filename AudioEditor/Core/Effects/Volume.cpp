@@ -1,4 +1,5 @@
 #include "Volume.h"
+#include "../Dsp/SampleKernels.h"
 #include <algorithm>
 #include <cmath>
 
@@ -24,13 +25,14 @@ void VolumeEffect::setParameter(const std::string& name, float value) {
     }
 }
 
-void VolumeEffect::apply(std::vector<float>& buffer) {
+std::map<std::string, float> VolumeEffect::getParameters() const {
+    return {{"gain", gain_}};
+}
+
+void VolumeEffect::process(std::vector<float>& block) {
     if (std::abs(gain_ - 1.0f) < 0.001f) {
         return;
     }
     
-    for (float& sample : buffer) {
-        sample *= gain_;
-        sample = std::clamp(sample, -1.0f, 1.0f);
-    }
+    dsp::applyGainClamped(block.data(), block.size(), gain_);
 }
@@ -9,8 +9,9 @@ class VolumeEffect : public IEffect {
 public:
     VolumeEffect(float gain, std::shared_ptr<ILogger> logger);
     
-    void apply(std::vector<float>& audioBuffer) override;
+    void process(std::vector<float>& block) override;
     void setParameter(const std::string& name, float value) override;
+    [[nodiscard]] std::map<std::string, float> getParameters() const override;
     [[nodiscard]] std::string getName() const noexcept override { return "Volume"; }
     
     void setGain(float gain);
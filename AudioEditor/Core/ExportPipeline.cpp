@@ -0,0 +1,220 @@
+#include "ExportPipeline.h"
+#include "AudioClip.h"
+#include "Constants.h"
+#include "Adapters/Mp3Encoder.h"
+#include "Adapters/Wav.h"
+#include "Effects/Normalize.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Rendered blocks between the render thread and the encoder. Either side may
+// close it: the producer when it has nothing more, the consumer when it gives
+// up, which also releases a producer waiting for room.
+class BlockQueue {
+public:
+    explicit BlockQueue(size_t capacity) : capacity_(capacity) {}
+    
+    [[nodiscard]] bool push(std::vector<float> block) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return closed_ || blocks_.size() < capacity_; });
+        if (closed_) return false;
+        
+        blocks_.push_back(std::move(block));
+        notEmpty_.notify_one();
+        return true;
+    }
+    
+    // Returns false once the queue is closed and drained.
+    [[nodiscard]] bool pop(std::vector<float>& block) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return closed_ || !blocks_.empty(); });
+        if (blocks_.empty()) return false;
+        
+        block = std::move(blocks_.front());
+        blocks_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+    
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+    
+private:
+    const size_t capacity_;
+    std::deque<std::vector<float>> blocks_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+};
+
+// Pushes source through chain[0, count) block by block and hands every
+// non-empty output block to sink. Each effect's flushed tail still runs
+// through the effects after it, as a whole-clip apply() per effect would.
+template <typename Sink>
+bool streamChain(const EditList& source, size_t channels, const std::vector<IEffect*>& chain,
+                 size_t count, const CancellationToken& token, Sink&& sink) {
+    using audio::render::kBlockFrames;
+    const size_t frames = source.frames();
+    std::vector<float> block;
+    
+    for (size_t frame = 0; frame < frames; frame += kBlockFrames) {
+        if (token.isCancelled()) return false;
+        
+        const size_t blockFrames = std::min(kBlockFrames, frames - frame);
+        block.resize(blockFrames * channels);
+        block.resize(source.read(frame, block.data(), blockFrames) * channels);
+        
+        for (size_t i = 0; i < count && !block.empty(); ++i) {
+            chain[i]->process(block);
+        }
+        if (!block.empty() && !sink(block)) return false;
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        if (token.isCancelled()) return false;
+        
+        chain[i]->flush(block);
+        for (size_t j = i + 1; j < count && !block.empty(); ++j) {
+            chain[j]->process(block);
+        }
+        if (!block.empty() && !sink(block)) return false;
+    }
+    
+    return !token.isCancelled();
+}
+
+void resetStreamingState(const std::vector<IEffect*>& chain) {
+    for (IEffect* effect : chain) {
+        if (!dynamic_cast<NormalizeEffect*>(effect)) {
+            effect->reset();
+        }
+    }
+}
+
+}
+
+ExportPipeline::ExportPipeline(std::shared_ptr<ILogger> logger)
+    : logger_(std::move(logger))
+{
+}
+
+bool ExportPipeline::analyzeNormalizers(const EditList& source, size_t channels,
+                                        const std::vector<IEffect*>& chain,
+                                        const CancellationToken& token) {
+    // Normalize needs the statistics of its whole input before its first
+    // block, so each one gets an analysis pass through the effects before it.
+    for (size_t i = 0; i < chain.size(); ++i) {
+        auto* normalize = dynamic_cast<NormalizeEffect*>(chain[i]);
+        if (!normalize) continue;
+        
+        const bool analyzed = streamChain(source, channels, chain, i, token,
+            [normalize](std::vector<float>& block) {
+                normalize->analyze(block);
+                return true;
+            });
+        if (!analyzed) return false;
+        
+        resetStreamingState(chain);
+    }
+    return true;
+}
+
+template <typename Writer>
+bool ExportPipeline::encode(Writer& writer, const EditList& source, size_t channels,
+                            const std::vector<IEffect*>& chain, size_t totalFrames,
+                            const CancellationToken& token, const ProgressCallback& progress) {
+    BlockQueue queue(audio::render::kExportQueueBlocks);
+    bool rendered = false;
+    
+    std::thread renderThread([&]() {
+        rendered = streamChain(source, channels, chain, chain.size(), token,
+            [&queue](std::vector<float>& block) {
+                return queue.push(std::move(block));
+            });
+        queue.close();
+    });
+    
+    bool written = true;
+    size_t framesWritten = 0;
+    std::vector<float> block;
+    
+    while (queue.pop(block)) {
+        if (token.isCancelled() || !writer.write(block.data(), block.size())) {
+            written = false;
+            break;
+        }
+        
+        framesWritten += block.size() / channels;
+        if (progress) {
+            progress(framesWritten, std::max(totalFrames, framesWritten));
+        }
+    }
+    
+    queue.close();
+    renderThread.join();
+    
+    return written && rendered && writer.finish();
+}
+
+bool ExportPipeline::run(const EditList& source, int sampleRate,
+                         const std::vector<std::shared_ptr<IEffect>>& effects,
+                         const std::string& outputPath, const CancellationToken& token,
+                         const ProgressCallback& progress) {
+    const int channels = source.channels();
+    if (source.empty()) {
+        if (logger_) {
+            logger_->error("Cannot export: no samples loaded");
+        }
+        return false;
+    }
+    
+    const auto frameChannels = static_cast<size_t>(channels);
+    std::vector<IEffect*> chain;
+    size_t totalFrames = source.frames();
+    
+    for (const auto& effect : effects) {
+        if (!effect) continue;
+        
+        effect->reset();
+        chain.push_back(effect.get());
+        totalFrames = effect->getOutputFrames(totalFrames);
+    }
+    
+    if (logger_) {
+        logger_->log("Exporting " + std::to_string(chain.size()) + " effects to " + outputPath);
+    }
+    
+    bool ok = analyzeNormalizers(source, frameChannels, chain, token);
+    
+    if (ok && AudioClip::hasWavExtension(outputPath)) {
+        WavWriter writer(logger_);
+        ok = writer.open(outputPath, sampleRate, channels) &&
+             encode(writer, source, frameChannels, chain, totalFrames, token, progress);
+    } else if (ok) {
+        Mp3Encoder encoder(logger_);
+        ok = encoder.open(outputPath, sampleRate, channels) &&
+             encode(encoder, source, frameChannels, chain, totalFrames, token, progress);
+    }
+    
+    if (logger_) {
+        if (ok) {
+            logger_->log("Exported: " + outputPath);
+        } else if (token.isCancelled()) {
+            logger_->log("Export cancelled: " + outputPath);
+        } else {
+            logger_->error("Export failed: " + outputPath);
+        }
+    }
+    
+    return ok;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "EditList.h"
+#include "SampleBuffer.h"
+#include "CancellationToken.h"
+#include "Effects/IEffect.h"
+#include "Logging/ILogger.h"
+
+// Renders an effect chain straight into an output file without holding the
+// rendered clip. A render thread pushes every block through the whole chain
+// into a bounded queue while the calling thread converts, encodes and writes
+// the blocks already rendered, so memory stays at a few blocks. Blocks are
+// pulled from an EditList, so an edited clip is never flattened.
+class ExportPipeline {
+public:
+    using ProgressCallback = std::function<void(size_t framesWritten, size_t totalFrames)>;
+
+    explicit ExportPipeline(std::shared_ptr<ILogger> logger);
+    ~ExportPipeline() = default;
+
+    ExportPipeline(const ExportPipeline&) = delete;
+    ExportPipeline& operator=(const ExportPipeline&) = delete;
+
+    // Writes WAV for a .wav path and MP3 otherwise. The effects are reset and
+    // run; on failure or cancellation the partial file is removed.
+    [[nodiscard]] bool run(const EditList& source, int sampleRate,
+                           const std::vector<std::shared_ptr<IEffect>>& effects,
+                           const std::string& outputPath, const CancellationToken& token,
+                           const ProgressCallback& progress = {});
+    [[nodiscard]] bool run(const SampleBuffer& source, int sampleRate, int channels,
+                           const std::vector<std::shared_ptr<IEffect>>& effects,
+                           const std::string& outputPath, const CancellationToken& token,
+                           const ProgressCallback& progress = {}) {
+        return run(EditList(source, channels), sampleRate, effects, outputPath, token, progress);
+    }
+
+private:
+    [[nodiscard]] static bool analyzeNormalizers(const EditList& source, size_t channels,
+                                                 const std::vector<IEffect*>& chain,
+                                                 const CancellationToken& token);
+
+    template <typename Writer>
+    [[nodiscard]] static bool encode(Writer& writer, const EditList& source, size_t channels,
+                                     const std::vector<IEffect*>& chain, size_t totalFrames,
+                                     const CancellationToken& token,
+                                     const ProgressCallback& progress);
+
+    std::shared_ptr<ILogger> logger_;
+};
@@ -0,0 +1,36 @@
+#include "RenderProgress.h"
+#include "Constants.h"
+#include <algorithm>
+
+using audio::render::kProgressGranuleFrames;
+
+RenderProgress::RenderProgress(size_t totalFrames)
+    : totalFrames_(totalFrames)
+    , granules_((totalFrames + kProgressGranuleFrames - 1) / kProgressGranuleFrames)
+    , written_(std::make_unique<std::atomic<size_t>[]>(granules_))
+{
+}
+
+size_t RenderProgress::granuleFrames(size_t granule) const noexcept {
+    const size_t start = granule * kProgressGranuleFrames;
+    return std::min(kProgressGranuleFrames, totalFrames_ - start);
+}
+
+void RenderProgress::markRendered(size_t firstFrame, size_t lastFrame) noexcept {
+    lastFrame = std::min(lastFrame, totalFrames_);
+    
+    while (firstFrame < lastFrame) {
+        const size_t granule = firstFrame / kProgressGranuleFrames;
+        const size_t granuleEnd = std::min((granule + 1) * kProgressGranuleFrames, lastFrame);
+        
+        written_[granule].fetch_add(granuleEnd - firstFrame, std::memory_order_release);
+        firstFrame = granuleEnd;
+    }
+}
+
+bool RenderProgress::isRendered(size_t frame) const noexcept {
+    if (frame >= totalFrames_) return false;
+    
+    const size_t granule = frame / kProgressGranuleFrames;
+    return written_[granule].load(std::memory_order_acquire) == granuleFrames(granule);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Tracks which frames of a buffer under construction have been written, in
+// granules of audio::render::kProgressGranuleFrames. Written by one render
+// thread, read lock-free by the playback thread.
+class RenderProgress {
+public:
+    explicit RenderProgress(size_t totalFrames);
+
+    RenderProgress(const RenderProgress&) = delete;
+    RenderProgress& operator=(const RenderProgress&) = delete;
+
+    // [firstFrame, lastFrame) is final; every frame must be reported exactly once.
+    void markRendered(size_t firstFrame, size_t lastFrame) noexcept;
+
+    // True once the whole granule containing frame has been written.
+    [[nodiscard]] bool isRendered(size_t frame) const noexcept;
+
+    [[nodiscard]] size_t totalFrames() const noexcept { return totalFrames_; }
+
+private:
+    [[nodiscard]] size_t granuleFrames(size_t granule) const noexcept;
+
+    size_t totalFrames_;
+    size_t granules_;
+    std::unique_ptr<std::atomic<size_t>[]> written_;
+};
@@ -0,0 +1,47 @@
+#include "SampleBuffer.h"
+#include <atomic>
+
+SampleBuffer::SampleBuffer(std::vector<float> samples)
+    : samples_(std::make_shared<std::vector<float>>(std::move(samples)))
+    , id_(nextId())
+{
+}
+
+SampleBuffer::SampleBuffer(std::vector<float> samples, uint64_t restoredId)
+    : samples_(std::make_shared<std::vector<float>>(std::move(samples)))
+    , id_(restoredId)
+{
+}
+
+SampleBuffer::SampleBuffer(std::shared_ptr<const void> owner, const float* data, size_t size)
+    : external_(owner, data)
+    , externalSize_(size)
+    , id_(nextId())
+{
+}
+
+std::vector<float>& SampleBuffer::mutableSamples() {
+    if (external_) {
+        samples_ = std::make_shared<std::vector<float>>(external_.get(), external_.get() + externalSize_);
+        external_.reset();
+        externalSize_ = 0;
+    } else if (!samples_) {
+        samples_ = std::make_shared<std::vector<float>>();
+    } else if (samples_.use_count() > 1) {
+        samples_ = std::make_shared<std::vector<float>>(*samples_);
+    }
+    id_ = nextId();
+    return *samples_;
+}
+
+void SampleBuffer::clear() noexcept {
+    samples_.reset();
+    external_.reset();
+    externalSize_ = 0;
+    id_ = 0;
+}
+
+uint64_t SampleBuffer::nextId() noexcept {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+}
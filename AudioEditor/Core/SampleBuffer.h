@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Reference-counted, immutable interleaved samples. Copying a SampleBuffer only
+// shares the storage; mutableSamples() detaches (copy-on-write) when shared.
+// The storage is either an owned vector or read-only memory kept alive by
+// another object, such as a memory-mapped file.
+class SampleBuffer {
+public:
+    SampleBuffer() = default;
+    explicit SampleBuffer(std::vector<float> samples);
+    // Rebuilds a version bit for bit (undo) under its original id, so caches
+    // keyed by id() still apply.
+    SampleBuffer(std::vector<float> samples, uint64_t restoredId);
+    SampleBuffer(std::shared_ptr<const void> owner, const float* data, size_t size);
+
+    [[nodiscard]] const float* data() const noexcept {
+        return samples_ ? samples_->data() : external_.get();
+    }
+    [[nodiscard]] size_t size() const noexcept { return samples_ ? samples_->size() : externalSize_; }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] const float* begin() const noexcept { return data(); }
+    [[nodiscard]] const float* end() const noexcept { return data() + size(); }
+    [[nodiscard]] float operator[](size_t index) const noexcept { return data()[index]; }
+
+    [[nodiscard]] std::vector<float>& mutableSamples();
+    [[nodiscard]] std::vector<float> toVector() const { return std::vector<float>(begin(), end()); }
+
+    // Identifies one version of the content; copies share it, edits renew it.
+    [[nodiscard]] uint64_t id() const noexcept { return id_; }
+    [[nodiscard]] long useCount() const noexcept {
+        return samples_ ? samples_.use_count() : external_.use_count();
+    }
+    [[nodiscard]] bool sharesStorageWith(const SampleBuffer& other) const noexcept {
+        return data() && data() == other.data();
+    }
+    // True while the samples live in memory owned elsewhere (not yet copied).
+    [[nodiscard]] bool isExternal() const noexcept { return external_ != nullptr; }
+
+    void clear() noexcept;
+
+private:
+    [[nodiscard]] static uint64_t nextId() noexcept;
+
+    std::shared_ptr<std::vector<float>> samples_;
+    std::shared_ptr<const float> external_;
+    size_t externalSize_ = 0;
+    uint64_t id_ = 0;
+};
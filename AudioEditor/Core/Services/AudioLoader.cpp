@@ -0,0 +1,199 @@
+#include "AudioLoader.h"
+#include "../Adapters/Wav.h"
+#include "../Constants.h"
+#include "PcmCache.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using audio::waveform::kLoadBlockFrames;
+
+AudioLoader::AudioLoader(std::string filePath, std::shared_ptr<ILogger> logger)
+    : filePath_(std::move(filePath))
+    , logger_(std::move(logger))
+{
+}
+
+bool AudioLoader::open() {
+    clip_ = std::make_shared<AudioClip>(filePath_, logger_);
+    clip_->setPcmCache(pcmCache_);
+    reader_ = clip_->openReader();
+    if (!reader_ || reader_->getChannels() <= 0 || reader_->getSampleRate() <= 0) {
+        if (logger_) {
+            logger_->error("Failed to open file: " + filePath_);
+        }
+        clip_.reset();
+        reader_.reset();
+        return false;
+    }
+    
+    sampleRate_ = reader_->getSampleRate();
+    channels_ = reader_->getChannels();
+    totalFrames_ = reader_->totalFrames();
+    pyramid_ = std::make_shared<PeakPyramid>(channels_);
+    
+    cachedPyramid_ = peakCache_ ? peakCache_->load(filePath_) : nullptr;
+    if (cachedPyramid_ && cachedPyramid_->channels() != channels_) {
+        cachedPyramid_.reset();
+    }
+    if (cachedPyramid_) {
+        // Exact, unlike the MP3 reader's estimate.
+        totalFrames_ = cachedPyramid_->frames();
+    }
+    return true;
+}
+
+bool AudioLoader::run(const CancellationToken& token, const ProgressCallback& progress) {
+    if (!clip_ || !reader_) {
+        return false;
+    }
+    
+    // WAV files and cached decodes are mapped in place, which beats copying
+    // them block by block through the reader; only the peak scan is left.
+    bool ok = false;
+    bool decoded = false;
+    if (WavAdapter::isWavFile(filePath_)) {
+        ok = clip_->load() && scanLoaded(token, progress);
+    } else if (clip_->loadFromPcmCache()) {
+        ok = scanLoaded(token, progress);
+    } else {
+        decoded = true;
+        ok = reader_->totalFrames() >= 2 * audio::kMp3MinSegmentFrames &&
+             std::thread::hardware_concurrency() > 1
+            ? decodeSegmented(token, progress)
+            : decodeStream(token, progress);
+    }
+    reader_.reset();
+    
+    if (!ok) {
+        if (logger_) {
+            logger_->log(token.isCancelled() ? "Load cancelled: " + filePath_
+                                             : "Failed to load file: " + filePath_);
+        }
+        clip_.reset();
+        return false;
+    }
+    
+    pyramid_->finish();
+    pyramid_->attachSource(clip_->getSamples());
+    if (decoded && pcmCache_) {
+        pcmCacheSamples_ = clip_->getSamples();
+    }
+    
+    if (peakCache_ && (!cachedPyramid_ || cachedPyramid_->frames() != totalFrames_)) {
+        if (!peakCache_->store(filePath_, *pyramid_) && logger_) {
+            logger_->warning("Could not cache peaks for " + filePath_);
+        }
+    }
+    return true;
+}
+
+void AudioLoader::storeInPcmCache() {
+    if (!pcmCache_ || pcmCacheSamples_.empty()) return;
+    
+    pcmCache_->store(filePath_, pcmCacheSamples_, sampleRate_, channels_);
+    pcmCacheSamples_ = SampleBuffer();
+}
+
+bool AudioLoader::scanLoaded(const CancellationToken& token, const ProgressCallback& progress) {
+    reader_.reset();
+    
+    const SampleBuffer& samples = clip_->getSamples();
+    const auto channels = static_cast<size_t>(channels_);
+    totalFrames_ = samples.size() / channels;
+    
+    for (size_t frame = 0; frame < totalFrames_; frame += kLoadBlockFrames) {
+        if (token.isCancelled()) {
+            return false;
+        }
+        
+        const size_t count = std::min(kLoadBlockFrames, totalFrames_ - frame);
+        pyramid_->append(samples.data() + frame * channels, count);
+        if (progress) {
+            progress(frame + count, totalFrames_);
+        }
+    }
+    return true;
+}
+
+bool AudioLoader::decodeSegmented(const CancellationToken& token, const ProgressCallback& progress) {
+    // The adapter decodes on its own readers, one per core, and hands the
+    // frames back in file order as each segment catches up.
+    reader_.reset();
+    
+    const size_t expected = totalFrames_;
+    size_t frames = 0;
+    clip_->setDecodeCallback([&](const float* block, size_t count) {
+        if (token.isCancelled()) {
+            return false;
+        }
+        pyramid_->append(block, count);
+        frames += count;
+        if (progress) {
+            progress(frames, std::max(expected, frames));
+        }
+        return true;
+    });
+    const bool loaded = clip_->decode();
+    clip_->setDecodeCallback({});
+    
+    if (!loaded || frames * static_cast<size_t>(channels_) != clip_->getSamples().size()) {
+        return false;
+    }
+    totalFrames_ = frames;
+    return true;
+}
+
+bool AudioLoader::decodeStream(const CancellationToken& token, const ProgressCallback& progress) {
+    const auto channels = static_cast<size_t>(channels_);
+    
+    std::vector<float> samples;
+    samples.reserve((totalFrames_ + audio::kMp3DecodeChunkFrames) * channels);
+    
+    size_t frames = 0;
+    while (true) {
+        if (token.isCancelled()) {
+            return false;
+        }
+        
+        samples.resize((frames + kLoadBlockFrames) * channels);
+        float* block = samples.data() + frames * channels;
+        const size_t got = reader_->read(block, kLoadBlockFrames);
+        if (got == 0) {
+            break;
+        }
+        
+        pyramid_->append(block, got);
+        frames += got;
+        if (progress) {
+            const size_t expected = cachedPyramid_ ? totalFrames_ : reader_->totalFrames();
+            progress(frames, std::max(expected, frames));
+        }
+    }
+    
+    // read() returns 0 on a decode error too; a truncated clip must not
+    // pass for the whole file.
+    const std::string error = reader_->error();
+    if (!error.empty()) {
+        if (logger_) {
+            logger_->error("Decoding " + filePath_ + " failed: " + error);
+        }
+        return false;
+    }
+    
+    if (frames == 0) {
+        if (logger_) {
+            logger_->error("No audio decoded from " + filePath_);
+        }
+        return false;
+    }
+    
+    samples.resize(frames * channels);
+    if (samples.capacity() - samples.size() > 2 * audio::kMp3DecodeChunkFrames * channels) {
+        samples.shrink_to_fit();
+    }
+    
+    totalFrames_ = frames;
+    clip_->adoptSamples(SampleBuffer(std::move(samples)), sampleRate_, channels_);
+    return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../AudioClip.h"
+#include "../CancellationToken.h"
+#include "../Logging/ILogger.h"
+#include "PeakCache.h"
+#include "PeakPyramid.h"
+#include <functional>
+#include <memory>
+#include <string>
+
+// Opens a clip block by block so a caller can load it off the GUI thread.
+// open() only reads the header, so the pyramid can be shown straight away;
+// run() then decodes on the calling thread, appending every block to the
+// pyramid and reporting progress between blocks. Long MP3s are decoded in
+// parallel segments, each appended once the ones before it are done.
+class AudioLoader {
+public:
+    using ProgressCallback = std::function<void(size_t framesLoaded, size_t totalFrames)>;
+
+    AudioLoader(std::string filePath, std::shared_ptr<ILogger> logger);
+
+    // With a cache, open() looks up the file's peaks and run() stores them.
+    void setPeakCache(std::shared_ptr<const PeakCache> cache) { peakCache_ = std::move(cache); }
+    // Passed on to the clip; a hit skips the decode and only scans peaks.
+    void setPcmCache(std::shared_ptr<PcmCache> cache) { pcmCache_ = std::move(cache); }
+
+    [[nodiscard]] bool open();
+    // Returns false on a decode error or when the token was cancelled.
+    [[nodiscard]] bool run(const CancellationToken& token, const ProgressCallback& progress);
+
+    [[nodiscard]] int getSampleRate() const noexcept { return sampleRate_; }
+    [[nodiscard]] int getChannels() const noexcept { return channels_; }
+    // May be an estimate until run() has returned.
+    [[nodiscard]] size_t totalFrames() const noexcept { return totalFrames_; }
+    // Built by run(); complete once it has returned true.
+    [[nodiscard]] std::shared_ptr<const PeakPyramid> pyramid() const noexcept { return pyramid_; }
+    // What to draw while run() is going: the cached peaks of the whole file
+    // when there were any, otherwise pyramid() as it fills in.
+    [[nodiscard]] std::shared_ptr<const PeakPyramid> previewPyramid() const noexcept {
+        return cachedPyramid_ ? cachedPyramid_ : pyramid_;
+    }
+    [[nodiscard]] const std::string& getFilePath() const noexcept { return filePath_; }
+
+    // The loaded clip after a successful run(); nullptr otherwise.
+    [[nodiscard]] std::shared_ptr<AudioClip> takeClip() noexcept { return std::move(clip_); }
+
+    // Writing a long decode to the PCM cache takes a while, so run() leaves
+    // it to this, meant for a worker thread once the clip is in use.
+    [[nodiscard]] bool hasPcmCacheEntryDue() const noexcept { return !pcmCacheSamples_.empty(); }
+    void storeInPcmCache();
+
+private:
+    [[nodiscard]] bool scanLoaded(const CancellationToken& token, const ProgressCallback& progress);
+    [[nodiscard]] bool decodeSegmented(const CancellationToken& token, const ProgressCallback& progress);
+    [[nodiscard]] bool decodeStream(const CancellationToken& token, const ProgressCallback& progress);
+
+    std::string filePath_;
+    std::shared_ptr<ILogger> logger_;
+    std::shared_ptr<AudioClip> clip_;
+    std::unique_ptr<AudioStreamReader> reader_;
+    std::shared_ptr<PeakPyramid> pyramid_;
+    std::shared_ptr<const PeakPyramid> cachedPyramid_;
+    std::shared_ptr<const PeakCache> peakCache_;
+    std::shared_ptr<PcmCache> pcmCache_;
+    // What run() decoded, shared with the clip until it is cached.
+    SampleBuffer pcmCacheSamples_;
+    int sampleRate_ = 0;
+    int channels_ = 0;
+    size_t totalFrames_ = 0;
+};
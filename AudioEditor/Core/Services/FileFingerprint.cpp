@@ -0,0 +1,75 @@
+#include "FileFingerprint.h"
+#include "../Constants.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 0xcbf29ce484222325ULL;
+
+uint64_t fnv1a(uint64_t hash, const unsigned char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+}
+
+bool FileFingerprint::compute(const std::string& filePath, FileFingerprint& result) {
+    std::error_code ec;
+    const uintmax_t size = fs::file_size(filePath, ec);
+    if (ec) return false;
+    const auto modified = fs::last_write_time(filePath, ec);
+    if (ec) return false;
+    
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) return false;
+    
+    using audio::cache::kFingerprintSampleBytes;
+    std::vector<unsigned char> buffer(kFingerprintSampleBytes);
+    uint64_t hash = kFnvOffset;
+    const uintmax_t offsets[] = {
+        0, size / 2, size > kFingerprintSampleBytes ? size - kFingerprintSampleBytes : 0
+    };
+    
+    for (const uintmax_t offset : offsets) {
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        hash = fnv1a(hash, buffer.data(), static_cast<size_t>(file.gcount()));
+        file.clear();
+    }
+    
+    result.size = static_cast<uint64_t>(size);
+    result.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+    result.contentHash = hash;
+    return true;
+}
+
+std::string FileFingerprint::hex() const {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016llx-%016llx-%016llx",
+                  static_cast<unsigned long long>(size),
+                  static_cast<unsigned long long>(modified),
+                  static_cast<unsigned long long>(contentHash));
+    return name;
+}
+
+std::string userCacheDirectory(const std::string& name) {
+    fs::path base;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        base = xdg;
+    } else if (const char* home = std::getenv("HOME"); home && *home) {
+        base = fs::path(home) / ".cache";
+    } else {
+        std::error_code ec;
+        base = fs::temp_directory_path(ec);
+    }
+    return (base / "audioeditor" / name).string();
+}
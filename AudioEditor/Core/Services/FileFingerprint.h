@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Identifies a file's contents cheaply for the on-disk caches: size,
+// modification time and an FNV-1a hash of a few spread samples of the bytes.
+// Hashing the whole file would cost as much as decoding it; the samples catch
+// in-place edits that keep both size and timestamp.
+struct FileFingerprint {
+    uint64_t size = 0;
+    int64_t modified = 0;
+    uint64_t contentHash = 0;
+
+    [[nodiscard]] static bool compute(const std::string& filePath, FileFingerprint& result);
+
+    // All three fields in hex, unique per fingerprint; used for cache file names.
+    [[nodiscard]] std::string hex() const;
+
+    [[nodiscard]] bool operator==(const FileFingerprint& other) const noexcept {
+        return size == other.size && modified == other.modified && contentHash == other.contentHash;
+    }
+};
+
+// $XDG_CACHE_HOME/audioeditor/<name>, falling back to ~/.cache and then the
+// system temp directory.
+[[nodiscard]] std::string userCacheDirectory(const std::string& name);
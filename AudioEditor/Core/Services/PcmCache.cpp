@@ -0,0 +1,149 @@
+#include "PcmCache.h"
+#include "../Adapters/Wav.h"
+#include "../Constants.h"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* kEntryExtension = ".wav";
+
+}
+
+PcmCache::PcmCache(std::shared_ptr<ILogger> logger, uint64_t capacityBytes, std::string directory)
+    : logger_(std::move(logger))
+    , capacityBytes_(capacityBytes)
+    , directory_(std::move(directory))
+{
+}
+
+std::string PcmCache::defaultDirectory() {
+    return userCacheDirectory("pcm");
+}
+
+uint64_t PcmCache::configuredCapacity() {
+    const char* value = std::getenv(audio::cache::kPcmCacheSizeVariable);
+    if (!value || !*value) return 0;
+    
+    char* end = nullptr;
+    const unsigned long long megabytes = std::strtoull(value, &end, 10);
+    return *end == '\0' ? static_cast<uint64_t>(megabytes) * 1024 * 1024 : 0;
+}
+
+std::string PcmCache::entryPath(const FileFingerprint& key) const {
+    return (fs::path(directory_) / (key.hex() + kEntryExtension)).string();
+}
+
+bool PcmCache::load(const std::string& audioPath, SampleBuffer& samples,
+                    int& sampleRate, int& channels) const {
+    if (capacityBytes_ == 0) return false;
+    
+    FileFingerprint key;
+    if (!FileFingerprint::compute(audioPath, key)) return false;
+    
+    const std::string path = entryPath(key);
+    std::error_code ec;
+    if (!fs::exists(path, ec)) return false;
+    
+    // A damaged entry is only a miss; the next store() replaces it.
+    WavAdapter entry(nullptr);
+    if (!entry.load(path)) {
+        fs::remove(path, ec);
+        return false;
+    }
+    
+    samples = entry.takeSamples();
+    sampleRate = entry.getSampleRate();
+    channels = entry.getChannels();
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    
+    if (logger_) {
+        logger_->log("Loaded decoded audio from cache for " + audioPath);
+    }
+    return true;
+}
+
+bool PcmCache::store(const std::string& audioPath, const SampleBuffer& samples,
+                     int sampleRate, int channels) {
+    const uint64_t bytes = samples.size() * sizeof(float);
+    if (capacityBytes_ == 0 || samples.empty() || bytes > capacityBytes_) {
+        return false;
+    }
+    
+    FileFingerprint key;
+    if (!FileFingerprint::compute(audioPath, key)) return false;
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    
+    const std::string path = entryPath(key);
+    if (fs::exists(path, ec)) return true;
+    
+    evict(bytes);
+    
+    // Written under a temporary name and renamed, so a concurrent load never
+    // maps half an entry.
+    const std::string temporary = path + ".tmp";
+    WavWriter writer(logger_);
+    if (!writer.open(temporary, sampleRate, channels) ||
+        !writer.write(samples.data(), samples.size()) ||
+        !writer.finish()) {
+        return false;
+    }
+    
+    fs::rename(temporary, path, ec);
+    if (ec) {
+        fs::remove(temporary, ec);
+        return false;
+    }
+    
+    if (logger_) {
+        logger_->log("Cached decoded audio for " + audioPath);
+    }
+    return true;
+}
+
+void PcmCache::evict(uint64_t incomingBytes) {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type lastUsed;
+        uint64_t bytes;
+    };
+    
+    std::vector<Entry> entries;
+    uint64_t totalBytes = 0;
+    std::error_code ec;
+    
+    for (const auto& item : fs::directory_iterator(directory_, ec)) {
+        if (!item.is_regular_file(ec) || item.path().extension() != kEntryExtension) continue;
+        
+        const uint64_t bytes = item.file_size(ec);
+        if (ec) continue;
+        const auto lastUsed = item.last_write_time(ec);
+        if (ec) continue;
+        
+        entries.push_back({item.path(), lastUsed, bytes});
+        totalBytes += bytes;
+    }
+    
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+    
+    // Mapped entries stay readable after removal, so eviction never breaks
+    // a clip that is still open.
+    for (const Entry& entry : entries) {
+        if (totalBytes + incomingBytes <= capacityBytes_) break;
+        
+        if (fs::remove(entry.path, ec)) {
+            totalBytes -= entry.bytes;
+            if (logger_) {
+                logger_->log("Evicted cached audio: " + entry.path.filename().string());
+            }
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "FileFingerprint.h"
+#include "../SampleBuffer.h"
+#include "../Logging/ILogger.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Decoded PCM of compressed files, kept as 32-bit float WAV so a hit is
+// memory-mapped in place by WavAdapter instead of being decoded again.
+// Entries are named after the source's FileFingerprint. The directory is held
+// under a size cap by evicting the least recently used entries; a hit
+// refreshes its entry's timestamp.
+class PcmCache {
+public:
+    PcmCache(std::shared_ptr<ILogger> logger, uint64_t capacityBytes,
+             std::string directory = defaultDirectory());
+
+    // On a hit, samples refer to the mapped entry.
+    [[nodiscard]] bool load(const std::string& audioPath, SampleBuffer& samples,
+                            int& sampleRate, int& channels) const;
+
+    // Clips larger than the whole cap are not stored.
+    bool store(const std::string& audioPath, const SampleBuffer& samples,
+               int sampleRate, int channels);
+
+    [[nodiscard]] uint64_t capacityBytes() const noexcept { return capacityBytes_; }
+
+    // userCacheDirectory("pcm").
+    [[nodiscard]] static std::string defaultDirectory();
+
+    // The cap set through audio::cache::kPcmCacheSizeVariable, in bytes;
+    // 0 when it is unset, meaning no cache.
+    [[nodiscard]] static uint64_t configuredCapacity();
+
+private:
+    [[nodiscard]] std::string entryPath(const FileFingerprint& key) const;
+    void evict(uint64_t incomingBytes);
+
+    std::shared_ptr<ILogger> logger_;
+    uint64_t capacityBytes_;
+    std::string directory_;
+    std::mutex mutex_;
+};
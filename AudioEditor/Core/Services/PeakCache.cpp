@@ -0,0 +1,100 @@
+#include "PeakCache.h"
+#include "../Constants.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kMagic[4] = {'A', 'E', 'P', 'K'};
+constexpr uint32_t kVersion = 1;
+
+template <typename T>
+void putRaw(std::vector<unsigned char>& out, T value) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+}
+
+PeakCache::PeakCache(std::shared_ptr<ILogger> logger, std::string directory)
+    : logger_(std::move(logger))
+    , directory_(std::move(directory))
+{
+}
+
+std::string PeakCache::defaultDirectory() {
+    return userCacheDirectory("peaks");
+}
+
+std::string PeakCache::entryPath(const FileFingerprint& key) const {
+    return (fs::path(directory_) / (key.hex() + ".peaks")).string();
+}
+
+std::vector<unsigned char> PeakCache::entryHeader(const FileFingerprint& key) {
+    std::vector<unsigned char> header(kMagic, kMagic + sizeof(kMagic));
+    putRaw(header, kVersion);
+    putRaw(header, key.size);
+    putRaw(header, key.modified);
+    putRaw(header, key.contentHash);
+    return header;
+}
+
+std::shared_ptr<PeakPyramid> PeakCache::load(const std::string& audioPath) const {
+    FileFingerprint key;
+    if (!FileFingerprint::compute(audioPath, key)) return nullptr;
+    
+    std::ifstream file(entryPath(key), std::ios::binary);
+    if (!file) return nullptr;
+    
+    const std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)),
+                                          std::istreambuf_iterator<char>());
+    
+    // The file name is only a hash; the header must match the key exactly.
+    const std::vector<unsigned char> header = entryHeader(key);
+    if (data.size() < header.size() || 
+        std::memcmp(data.data(), header.data(), header.size()) != 0) {
+        return nullptr;
+    }
+    
+    auto pyramid = PeakPyramid::deserialize(data.data() + header.size(), data.size() - header.size());
+    if (pyramid && logger_) {
+        logger_->log("Loaded cached peaks for " + audioPath);
+    }
+    return pyramid;
+}
+
+bool PeakCache::store(const std::string& audioPath, const PeakPyramid& pyramid) const {
+    FileFingerprint key;
+    if (!FileFingerprint::compute(audioPath, key)) return false;
+    
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    
+    std::vector<unsigned char> data = entryHeader(key);
+    const std::vector<unsigned char> body = pyramid.serialize(audio::waveform::kPeakCacheMaxLevelEntries);
+    data.insert(data.end(), body.begin(), body.end());
+    
+    // Write then rename, so a concurrent reader never sees half an entry.
+    const std::string path = entryPath(key);
+    const std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    file.close();
+    
+    if (!file) {
+        fs::remove(temporary, ec);
+        return false;
+    }
+    
+    fs::rename(temporary, path, ec);
+    if (ec) {
+        fs::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "FileFingerprint.h"
+#include "PeakPyramid.h"
+#include "../Logging/ILogger.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Keeps the coarse levels of finished peak pyramids on disk so reopening a
+// large file can show its waveform before the decode has finished. Entries
+// are keyed by FileFingerprint, so a renamed file still hits and an edited
+// one misses.
+class PeakCache {
+public:
+    explicit PeakCache(std::shared_ptr<ILogger> logger,
+                       std::string directory = defaultDirectory());
+
+    // nullptr on a miss or an unreadable entry.
+    [[nodiscard]] std::shared_ptr<PeakPyramid> load(const std::string& audioPath) const;
+
+    [[nodiscard]] bool store(const std::string& audioPath, const PeakPyramid& pyramid) const;
+
+    // userCacheDirectory("peaks").
+    [[nodiscard]] static std::string defaultDirectory();
+
+private:
+    [[nodiscard]] static std::vector<unsigned char> entryHeader(const FileFingerprint& key);
+    [[nodiscard]] std::string entryPath(const FileFingerprint& key) const;
+
+    std::shared_ptr<ILogger> logger_;
+    std::string directory_;
+};
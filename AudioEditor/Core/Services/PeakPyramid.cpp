@@ -0,0 +1,347 @@
+#include "PeakPyramid.h"
+#include "../Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+using audio::waveform::kPeakBaseBlockFrames;
+using audio::waveform::kPeakLevelFactor;
+
+PeakPyramid::PeakPyramid(int channels)
+    : channels_(std::max(1, channels))
+    , openBlock_(static_cast<size_t>(channels_), emptyEntry())
+{
+}
+
+PeakPyramid::PeakPyramid(const SampleBuffer& samples, int channels)
+    : PeakPyramid(channels)
+{
+    append(samples.data(), samples.size() / static_cast<size_t>(channels_));
+    finish();
+    attachSource(samples);
+}
+
+void PeakPyramid::attachSource(const SampleBuffer& samples) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    source_ = samples;
+}
+
+PeakPyramid::Entry PeakPyramid::emptyEntry() noexcept {
+    return {0.0f, 0.0f, 0.0f, 0};
+}
+
+void PeakPyramid::merge(Entry& into, const Entry& from) noexcept {
+    if (from.frames == 0) return;
+    
+    if (into.frames == 0) {
+        into = from;
+        return;
+    }
+    
+    into.min = std::min(into.min, from.min);
+    into.max = std::max(into.max, from.max);
+    into.sumSquares += from.sumSquares;
+    into.frames += from.frames;
+}
+
+PeakPyramid::Summary PeakPyramid::toSummary(const Entry& entry) noexcept {
+    if (entry.frames == 0) return {};
+    return {entry.min, entry.max, std::sqrt(entry.sumSquares / static_cast<float>(entry.frames))};
+}
+
+size_t PeakPyramid::blockFrames(size_t level) const noexcept {
+    size_t frames = kPeakBaseBlockFrames;
+    for (size_t i = 0; i < level; ++i) {
+        frames *= kPeakLevelFactor;
+    }
+    return frames;
+}
+
+void PeakPyramid::append(const float* interleaved, size_t frames) {
+    if (!interleaved) return;
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto channels = static_cast<size_t>(channels_);
+    
+    for (size_t f = 0; f < frames; ++f) {
+        const float* frame = interleaved + f * channels;
+        
+        for (size_t ch = 0; ch < channels; ++ch) {
+            const float sample = frame[ch];
+            Entry& entry = openBlock_[ch];
+            
+            if (entry.frames == 0) {
+                entry.min = sample;
+                entry.max = sample;
+            } else {
+                entry.min = std::min(entry.min, sample);
+                entry.max = std::max(entry.max, sample);
+            }
+            entry.sumSquares += sample * sample;
+            ++entry.frames;
+        }
+        
+        if (openBlock_[0].frames == kPeakBaseBlockFrames) {
+            pushEntries(0, openBlock_.data());
+            std::fill(openBlock_.begin(), openBlock_.end(), emptyEntry());
+        }
+    }
+    
+    frames_ += frames;
+}
+
+void PeakPyramid::pushEntries(size_t level, const Entry* entries) {
+    const auto channels = static_cast<size_t>(channels_);
+    
+    if (levels_.size() <= level) {
+        levels_.resize(level + 1);
+    }
+    
+    Level& current = levels_[level];
+    current.insert(current.end(), entries, entries + channels);
+    
+    const size_t count = current.size() / channels;
+    if (count % kPeakLevelFactor != 0) {
+        return;
+    }
+    
+    std::vector<Entry> parent(channels, emptyEntry());
+    for (size_t i = count - kPeakLevelFactor; i < count; ++i) {
+        for (size_t ch = 0; ch < channels; ++ch) {
+            merge(parent[ch], current[i * channels + ch]);
+        }
+    }
+    pushEntries(level + 1, parent.data());
+}
+
+void PeakPyramid::finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto channels = static_cast<size_t>(channels_);
+    
+    if (openBlock_[0].frames > 0) {
+        pushEntries(0, openBlock_.data());
+        std::fill(openBlock_.begin(), openBlock_.end(), emptyEntry());
+    }
+    
+    // Fold every trailing partial group into the level above so coarse levels
+    // cover the whole clip too.
+    for (size_t level = 0; level < levels_.size(); ++level) {
+        const size_t count = levels_[level].size() / channels;
+        const size_t remainder = count % kPeakLevelFactor;
+        if (count <= 1 || remainder == 0) {
+            continue;
+        }
+        
+        std::vector<Entry> parent(channels, emptyEntry());
+        for (size_t i = count - remainder; i < count; ++i) {
+            for (size_t ch = 0; ch < channels; ++ch) {
+                merge(parent[ch], levels_[level][i * channels + ch]);
+            }
+        }
+        
+        if (levels_.size() <= level + 1) {
+            levels_.resize(level + 2);
+        }
+        levels_[level + 1].insert(levels_[level + 1].end(), parent.begin(), parent.end());
+    }
+}
+
+PeakPyramid::Entry PeakPyramid::scanRaw(size_t firstFrame, size_t lastFrame, int channel) const {
+    const auto channels = static_cast<size_t>(channels_);
+    Entry result = emptyEntry();
+    
+    for (size_t f = firstFrame; f < lastFrame; ++f) {
+        for (size_t ch = 0; ch < channels; ++ch) {
+            if (channel != kAllChannels && static_cast<size_t>(channel) != ch) continue;
+            
+            const float sample = source_[f * channels + ch];
+            merge(result, {sample, sample, sample * sample, 1});
+        }
+    }
+    
+    return result;
+}
+
+PeakPyramid::Entry PeakPyramid::scanLevel(size_t level, size_t firstFrame, size_t lastFrame,
+                                          int channel) const {
+    const auto channels = static_cast<size_t>(channels_);
+    Entry result = emptyEntry();
+    
+    if (firstFrame >= lastFrame) {
+        return result;
+    }
+    
+    const size_t block = blockFrames(level);
+    const size_t count = level < levels_.size() ? levels_[level].size() / channels : 0;
+    const size_t covered = std::min(lastFrame, count * block);
+    
+    if (firstFrame < covered) {
+        const size_t firstEntry = firstFrame / block;
+        const size_t lastEntry = (covered + block - 1) / block;
+        
+        for (size_t i = firstEntry; i < lastEntry && i < count; ++i) {
+            for (size_t ch = 0; ch < channels; ++ch) {
+                if (channel != kAllChannels && static_cast<size_t>(channel) != ch) continue;
+                merge(result, levels_[level][i * channels + ch]);
+            }
+        }
+    }
+    
+    // While the pyramid is still being appended to, the newest frames only
+    // exist in finer levels (or the open block).
+    if (covered < lastFrame) {
+        const size_t from = std::max(firstFrame, covered);
+        if (level > 0) {
+            merge(result, scanLevel(level - 1, from, lastFrame, channel));
+        } else {
+            for (size_t ch = 0; ch < channels; ++ch) {
+                if (channel != kAllChannels && static_cast<size_t>(channel) != ch) continue;
+                merge(result, openBlock_[ch]);
+            }
+        }
+    }
+    
+    return result;
+}
+
+std::vector<PeakPyramid::Summary> PeakPyramid::summarize(size_t firstFrame, size_t lastFrame,
+                                                         int columns, int channel) const {
+    std::vector<Summary> result(static_cast<size_t>(std::max(0, columns)));
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    lastFrame = std::min(lastFrame, frames_);
+    if (result.empty() || firstFrame >= lastFrame) {
+        return result;
+    }
+    
+    const double framesPerColumn = static_cast<double>(lastFrame - firstFrame) / columns;
+    const bool useRaw = framesPerColumn < kPeakBaseBlockFrames && 
+                        source_.size() >= frames_ * static_cast<size_t>(channels_);
+    
+    size_t level = 0;
+    while (level + 1 < levels_.size() && blockFrames(level + 1) <= framesPerColumn) {
+        ++level;
+    }
+    while (level + 1 < levels_.size() && levels_[level].empty()) {
+        ++level;
+    }
+    
+    for (int x = 0; x < columns; ++x) {
+        const size_t start = firstFrame + static_cast<size_t>(x * framesPerColumn);
+        size_t end = firstFrame + static_cast<size_t>((x + 1) * framesPerColumn);
+        end = std::min(std::max(end, start + 1), lastFrame);
+        
+        if (start >= lastFrame) {
+            break;
+        }
+        
+        const Entry entry = useRaw ? scanRaw(start, end, channel) 
+                                   : scanLevel(level, start, end, channel);
+        result[static_cast<size_t>(x)] = toSummary(entry);
+    }
+    
+    return result;
+}
+
+namespace {
+
+// Native byte order: cache entries never leave the machine that wrote them.
+template <typename T>
+void putRaw(std::vector<unsigned char>& out, T value) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+bool getRaw(const unsigned char*& data, const unsigned char* end, T& value) {
+    if (static_cast<size_t>(end - data) < sizeof(T)) return false;
+    std::memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return true;
+}
+
+// Levels whose block size still fits in size_t; a deeper one would wrap to 0.
+constexpr size_t maxLevels() {
+    size_t levels = 1;
+    for (size_t block = kPeakBaseBlockFrames;
+         block <= std::numeric_limits<size_t>::max() / kPeakLevelFactor;
+         block *= kPeakLevelFactor) {
+        ++levels;
+    }
+    return levels;
+}
+
+}
+
+std::vector<unsigned char> PeakPyramid::serialize(size_t maxLevelEntries) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto channels = static_cast<size_t>(channels_);
+    std::vector<unsigned char> out;
+    
+    putRaw<uint32_t>(out, static_cast<uint32_t>(channels_));
+    putRaw<uint64_t>(out, frames_);
+    putRaw<uint32_t>(out, static_cast<uint32_t>(levels_.size()));
+    
+    // Entry frame counts follow from the level and position, so only the
+    // statistics are stored.
+    for (const Level& level : levels_) {
+        const size_t count = level.size() / channels;
+        const bool keep = count <= maxLevelEntries;
+        putRaw<uint64_t>(out, keep ? count : 0);
+        if (!keep) continue;
+        
+        for (const Entry& entry : level) {
+            putRaw<float>(out, entry.min);
+            putRaw<float>(out, entry.max);
+            putRaw<float>(out, entry.sumSquares);
+        }
+    }
+    return out;
+}
+
+std::shared_ptr<PeakPyramid> PeakPyramid::deserialize(const unsigned char* data, size_t size) {
+    const unsigned char* end = data + size;
+    uint32_t channels = 0;
+    uint64_t frames = 0;
+    uint32_t levelCount = 0;
+    
+    // No source format carries more channels than WAV's 16-bit field.
+    if (!getRaw(data, end, channels) || !getRaw(data, end, frames) ||
+        !getRaw(data, end, levelCount) || channels == 0 ||
+        channels > std::numeric_limits<uint16_t>::max() || levelCount > maxLevels()) {
+        return nullptr;
+    }
+    
+    auto pyramid = std::make_shared<PeakPyramid>(static_cast<int>(channels));
+    pyramid->frames_ = static_cast<size_t>(frames);
+    pyramid->levels_.resize(levelCount);
+    
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        uint64_t count = 0;
+        if (!getRaw(data, end, count)) return nullptr;
+        
+        const size_t block = pyramid->blockFrames(level);
+        const size_t entryBytes = size_t{channels} * 3 * sizeof(float);
+        if (count > frames / block + (frames % block != 0) ||
+            count > static_cast<size_t>(end - data) / entryBytes) {
+            return nullptr;
+        }
+        
+        Level& entries = pyramid->levels_[level];
+        entries.resize(static_cast<size_t>(count) * channels);
+        
+        for (size_t i = 0; i < entries.size(); ++i) {
+            Entry& entry = entries[i];
+            const size_t first = (i / channels) * block;
+            entry.frames = std::min<size_t>(block, static_cast<size_t>(frames) - first);
+            if (!getRaw(data, end, entry.min) || !getRaw(data, end, entry.max) ||
+                !getRaw(data, end, entry.sumSquares)) {
+                return nullptr;
+            }
+        }
+    }
+    
+    return data == end ? pyramid : nullptr;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../SampleBuffer.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Multi-resolution min/max/RMS summary of a clip, built once per buffer
+// version. Level 0 summarises kPeakBaseBlockFrames frames per entry and every
+// further level kPeakLevelFactor entries of the level below, so any zoom can
+// be drawn from the nearest level in O(columns). One thread may append while
+// others summarize, so a loader can publish the pyramid before it is complete.
+class PeakPyramid {
+public:
+    struct Summary {
+        float min = 0.0f;
+        float max = 0.0f;
+        float rms = 0.0f;
+    };
+
+    static constexpr int kAllChannels = -1;
+
+    explicit PeakPyramid(int channels);
+    PeakPyramid(const SampleBuffer& samples, int channels);
+
+    void append(const float* interleaved, size_t frames);
+    void finish();
+
+    // Lets deep zoom levels read the raw frames once a progressively built
+    // pyramid has all of them. The source only sharpens deep zoom, so it may
+    // be swapped on a shared pyramid; detaching it stops the pyramid pinning
+    // that buffer version while it sits in a cache.
+    void attachSource(const SampleBuffer& samples) const;
+    void detachSource() const { attachSource(SampleBuffer()); }
+
+    // Compact form of a finished pyramid for the on-disk cache. Levels with
+    // more than maxLevelEntries entries per channel are left out; summarize()
+    // falls back to the finest level that was kept.
+    [[nodiscard]] std::vector<unsigned char> serialize(size_t maxLevelEntries) const;
+    [[nodiscard]] static std::shared_ptr<PeakPyramid> deserialize(const unsigned char* data,
+                                                                  size_t size);
+
+    [[nodiscard]] std::vector<Summary> summarize(size_t firstFrame, size_t lastFrame, int columns,
+                                                 int channel = kAllChannels) const;
+
+    [[nodiscard]] size_t frames() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return frames_;
+    }
+    [[nodiscard]] int channels() const noexcept { return channels_; }
+    [[nodiscard]] size_t levelCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return levels_.size();
+    }
+
+private:
+    struct Entry {
+        float min;
+        float max;
+        float sumSquares;
+        size_t frames;
+    };
+
+    using Level = std::vector<Entry>;   // interleaved by channel
+
+    static void merge(Entry& into, const Entry& from) noexcept;
+    [[nodiscard]] static Entry emptyEntry() noexcept;
+    [[nodiscard]] static Summary toSummary(const Entry& entry) noexcept;
+
+    void pushEntries(size_t level, const Entry* entries);
+    [[nodiscard]] size_t blockFrames(size_t level) const noexcept;
+    [[nodiscard]] Entry scanRaw(size_t firstFrame, size_t lastFrame, int channel) const;
+    [[nodiscard]] Entry scanLevel(size_t level, size_t firstFrame, size_t lastFrame, int channel) const;
+
+    int channels_;
+    size_t frames_ = 0;
+    std::vector<Level> levels_;
+    std::vector<Entry> openBlock_;
+    mutable SampleBuffer source_;
+    mutable std::mutex mutex_;
+};
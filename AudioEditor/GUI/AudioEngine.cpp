@@ -1,4 +1,5 @@
 #include "AudioEngine.h"
+#include "SampleStreamDevice.h"
 #include "../Core/AudioClip.h"
 #include "../Core/Effects/Reverb.h"
 #include "../Core/Effects/Speed.h"
@@ -13,7 +14,7 @@ AudioEngine::AudioEngine(QObject* parent)
     : QObject(parent)
     , audioClip_(nullptr)
     , audioSink_(nullptr)
-    , audioBuffer_(nullptr)
+    , stream_(new SampleStreamDevice(this))
     , positionTimer_(new QTimer(this))
     , state_(PlaybackState::Stopped)
     , volume_(1.0f)
@@ -28,7 +29,6 @@ AudioEngine::AudioEngine(QObject* parent)
 AudioEngine::~AudioEngine() {
     stop();
     delete audioSink_;
-    delete audioBuffer_;
 }
 
 void AudioEngine::setAudioClip(std::shared_ptr<AudioClip> clip) {
@@ -37,22 +37,22 @@ void AudioEngine::setAudioClip(std::shared_ptr<AudioClip> clip) {
     audioClip_ = clip;
     
     if (audioClip_ && audioClip_->isLoaded()) {
-        sampleRate_ = 44100;
-        channels_ = 2;
+        sampleRate_ = audioClip_->getSampleRate();
+        channels_ = audioClip_->getChannels();
         
-        originalSamples_ = audioClip_->getSamples();
+        originalEdits_ = audioClip_->getEditList();
         previewSamples_.clear();
         hasPreview_ = false;
         
-        convertSamplesToBytes();
+        stream_->setEdits(originalEdits_);
         setupAudio();
         
         emit durationChanged(getDurationMs());
     } else {
-        originalSamples_.clear();
+        originalEdits_ = EditList(channels_);
         previewSamples_.clear();
         hasPreview_ = false;
-        audioData_.clear();
+        stream_->setEdits(originalEdits_);
     }
 }
 
@@ -67,11 +67,6 @@ void AudioEngine::setupAudio() {
         audioSink_ = nullptr;
     }
     
-    if (audioBuffer_) {
-        delete audioBuffer_;
-        audioBuffer_ = nullptr;
-    }
-    
     QAudioFormat format;
     format.setSampleRate(sampleRate_);
     format.setChannelCount(channels_);
@@ -93,29 +88,30 @@ void AudioEngine::setupAudio() {
     
     connect(audioSink_, &QAudioSink::stateChanged, 
             this, &AudioEngine::onAudioStateChanged);
-    
-    audioBuffer_ = new QBuffer(&audioData_, this);
 }
 
-void AudioEngine::convertSamplesToBytes() {
-    if (!audioClip_ || audioClip_->getSamples().empty()) {
-        audioData_.clear();
-        return;
-    }
+void AudioEngine::setPlaybackEdits(const EditList& edits,
+                                   std::shared_ptr<const RenderProgress> progress) {
+    const qint64 samples = static_cast<qint64>(edits.frames()) * edits.channels();
+    const bool lengthChanged = stream_->size() != samples * SampleStreamDevice::kBytesPerSample;
     
-    const std::vector<float>& samples = audioClip_->getSamples();
+    stream_->setEdits(edits, std::move(progress));
     
-    audioData_.resize(static_cast<qsizetype>(samples.size() * sizeof(qint16)));
-    qint16* dataPtr = reinterpret_cast<qint16*>(audioData_.data());
+    if (state_ != PlaybackState::Playing) {
+        pausedPosition_ = std::min(pausedPosition_, stream_->size());
+    }
     
-    for (size_t i = 0; i < samples.size(); ++i) {
-        float sample = std::clamp(samples[i], -1.0f, 1.0f);
-        dataPtr[i] = static_cast<qint16>(sample * 32767.0f);
+    if (lengthChanged) {
+        emit durationChanged(getDurationMs());
     }
 }
 
+qint64 AudioEngine::bytesPerSecond() const {
+    return static_cast<qint64>(sampleRate_) * channels_ * SampleStreamDevice::kBytesPerSample;
+}
+
 void AudioEngine::play() {
-    if (!audioSink_ || audioData_.isEmpty()) {
+    if (!audioSink_ || stream_->size() == 0) {
         qWarning() << "Cannot play: no audio loaded";
         return;
     }
@@ -124,15 +120,15 @@ void AudioEngine::play() {
         return;
     }
     
+    stream_->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    
     if (state_ == PlaybackState::Paused) {
-        audioBuffer_->open(QIODevice::ReadOnly);
-        audioBuffer_->seek(pausedPosition_);
+        stream_->seek(pausedPosition_);
     } else {
-        audioBuffer_->open(QIODevice::ReadOnly);
-        audioBuffer_->seek(0);
+        stream_->seek(0);
     }
     
-    audioSink_->start(audioBuffer_);
+    audioSink_->start(stream_);
     
     state_ = PlaybackState::Playing;
     emit stateChanged(state_);
@@ -145,10 +141,10 @@ void AudioEngine::pause() {
         return;
     }
     
-    pausedPosition_ = audioBuffer_->pos();
+    pausedPosition_ = stream_->pos();
     
     audioSink_->stop();
-    audioBuffer_->close();
+    stream_->close();
     
     state_ = PlaybackState::Paused;
     emit stateChanged(state_);
@@ -165,8 +161,8 @@ void AudioEngine::stop() {
         audioSink_->stop();
     }
     
-    if (audioBuffer_ && audioBuffer_->isOpen()) {
-        audioBuffer_->close();
+    if (stream_->isOpen()) {
+        stream_->close();
     }
     
     pausedPosition_ = 0;
@@ -179,23 +175,23 @@ void AudioEngine::stop() {
 }
 
 void AudioEngine::seek(qint64 positionMs) {
-    if (!audioBuffer_ || audioData_.isEmpty()) {
+    if (stream_->size() == 0) {
         return;
     }
     
-    qint64 bytePosition = (positionMs * sampleRate_ * channels_ * static_cast<qint64>(sizeof(qint16))) / 1000;
+    qint64 bytePosition = (positionMs * bytesPerSecond()) / 1000;
     
-    int frameSize = channels_ * static_cast<int>(sizeof(qint16));
+    int frameSize = channels_ * static_cast<int>(SampleStreamDevice::kBytesPerSample);
     bytePosition = (bytePosition / frameSize) * frameSize;
     
-    bytePosition = std::clamp(bytePosition, qint64(0), qint64(audioData_.size()));
+    bytePosition = std::clamp(bytePosition, qint64(0), stream_->size());
     
     if (state_ == PlaybackState::Playing) {
         audioSink_->stop();
-        audioBuffer_->close();
-        audioBuffer_->open(QIODevice::ReadOnly);
-        audioBuffer_->seek(bytePosition);
-        audioSink_->start(audioBuffer_);
+        stream_->close();
+        stream_->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+        stream_->seek(bytePosition);
+        audioSink_->start(stream_);
     } else {
         pausedPosition_ = bytePosition;
     }
@@ -208,30 +204,25 @@ PlaybackState AudioEngine::getState() const {
 }
 
 qint64 AudioEngine::getPositionMs() const {
-    if (!audioBuffer_ || audioData_.isEmpty()) {
+    if (stream_->size() == 0) {
         return 0;
     }
     
     qint64 bytePos;
     
-    if (state_ == PlaybackState::Playing && audioBuffer_->isOpen()) {
-        bytePos = audioBuffer_->pos();
+    if (state_ == PlaybackState::Playing && stream_->isOpen()) {
+        bytePos = stream_->pos();
     } else {
         bytePos = pausedPosition_;
     }
     
-    qint64 positionMs = (bytePos * 1000) / (sampleRate_ * channels_ * static_cast<qint64>(sizeof(qint16)));
+    qint64 positionMs = (bytePos * 1000) / bytesPerSecond();
     
     return positionMs;
 }
 
 qint64 AudioEngine::getDurationMs() const {
-    if (audioData_.isEmpty()) {
-        return 0;
-    }
-    
-    qint64 durationMs = (audioData_.size() * 1000) / 
-                        (sampleRate_ * channels_ * static_cast<qint64>(sizeof(qint16)));
+    qint64 durationMs = (stream_->size() * 1000) / bytesPerSecond();
     
     return durationMs;
 }
@@ -278,14 +269,16 @@ void AudioEngine::updatePosition() {
     }
 }
 
-void AudioEngine::setOriginalSamples(const std::vector<float>& samples) {
-    originalSamples_ = samples;
+void AudioEngine::setOriginalEdits(const EditList& edits) {
+    originalEdits_ = edits;
     previewSamples_.clear();
     hasPreview_ = false;
+    
+    setPlaybackEdits(originalEdits_);
 }
 
 void AudioEngine::previewWithEffects(const std::vector<std::shared_ptr<IEffect>>& effects) {
-    if (originalSamples_.empty()) {
+    if (originalEdits_.empty()) {
         qWarning() << "previewWithEffects: No original samples loaded";
         return;
     }
@@ -295,7 +288,7 @@ void AudioEngine::previewWithEffects(const std::vector<std::shared_ptr<IEffect>>
         return;
     }
     
-    previewSamples_ = originalSamples_;
+    std::vector<float> processed = originalEdits_.render().toVector();
     
     for (const auto& effect : effects) {
         if (!effect) continue;
@@ -304,22 +297,17 @@ void AudioEngine::previewWithEffects(const std::vector<std::shared_ptr<IEffect>>
             reverb->reset();
         }
         
-        effect->apply(previewSamples_);
+        effect->apply(processed);
     }
     
+    previewSamples_ = SampleBuffer(std::move(processed));
     hasPreview_ = true;
     
-    audioData_.resize(static_cast<qsizetype>(previewSamples_.size() * sizeof(qint16)));
-    qint16* dataPtr = reinterpret_cast<qint16*>(audioData_.data());
-    for (size_t i = 0; i < previewSamples_.size(); ++i) {
-        float sample = std::clamp(previewSamples_[i], -1.0f, 1.0f);
-        dataPtr[i] = static_cast<qint16>(sample * 32767.0f);
-    }
-    
-    emit durationChanged(getDurationMs());
+    setPlaybackEdits(EditList(previewSamples_, channels_));
 }
 
-void AudioEngine::previewWithSamples(const std::vector<float>& samples) {
+void AudioEngine::previewWithSamples(const SampleBuffer& samples,
+                                     std::shared_ptr<const RenderProgress> progress) {
     if (samples.empty()) {
         revertToOriginal();
         return;
@@ -328,37 +316,23 @@ void AudioEngine::previewWithSamples(const std::vector<float>& samples) {
     previewSamples_ = samples;
     hasPreview_ = true;
 
-    audioData_.resize(static_cast<qsizetype>(previewSamples_.size() * sizeof(qint16)));
-    qint16* dataPtr = reinterpret_cast<qint16*>(audioData_.data());
-    for (size_t i = 0; i < previewSamples_.size(); ++i) {
-        float sample = std::clamp(previewSamples_[i], -1.0f, 1.0f);
-        dataPtr[i] = static_cast<qint16>(sample * 32767.0f);
-    }
-
-    emit durationChanged(getDurationMs());
+    setPlaybackEdits(EditList(previewSamples_, channels_), std::move(progress));
 }
 
 void AudioEngine::commitEffects() {
     if (hasPreview_ && !previewSamples_.empty()) {
-        originalSamples_ = previewSamples_;
+        originalEdits_ = EditList(previewSamples_, channels_);
         hasPreview_ = false;
     }
 }
 
 void AudioEngine::revertToOriginal() {
-    if (originalSamples_.empty()) {
+    if (originalEdits_.empty()) {
         return;
     }
     
     previewSamples_.clear();
     hasPreview_ = false;
     
-    audioData_.resize(static_cast<qsizetype>(originalSamples_.size() * sizeof(qint16)));
-    qint16* dataPtr = reinterpret_cast<qint16*>(audioData_.data());
-    for (size_t i = 0; i < originalSamples_.size(); ++i) {
-        float sample = std::clamp(originalSamples_[i], -1.0f, 1.0f);
-        dataPtr[i] = static_cast<qint16>(sample * 32767.0f);
-    }
-    
-    emit durationChanged(getDurationMs());
+    setPlaybackEdits(originalEdits_);
 }
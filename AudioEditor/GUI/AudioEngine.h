@@ -4,14 +4,16 @@
 #include <QObject>
 #include <QAudioSink>
 #include <QAudioFormat>
-#include <QBuffer>
 #include <QTimer>
-#include <QByteArray>
 #include <memory>
 #include <vector>
 #include "../Core/Effects/IEffect.h"
+#include "../Core/EditList.h"
+#include "../Core/SampleBuffer.h"
+#include "../Core/RenderProgress.h"
 
 class AudioClip;
+class SampleStreamDevice;
 
 enum class PlaybackState {
     Stopped,
@@ -42,9 +44,12 @@ public:
     [[nodiscard]] qint64 getDurationMs() const;
     [[nodiscard]] float getVolume() const;
 
-    void setOriginalSamples(const std::vector<float>& samples);
+    // Swaps in another version of the current clip (undo/redo) without
+    // rebuilding the audio output; playback carries on where it was.
+    void setOriginalEdits(const EditList& edits);
     void previewWithEffects(const std::vector<std::shared_ptr<IEffect>>& effects);
-    void previewWithSamples(const std::vector<float>& samples);
+    void previewWithSamples(const SampleBuffer& samples,
+                            std::shared_ptr<const RenderProgress> progress = nullptr);
     void commitEffects();
     void revertToOriginal();
     [[nodiscard]] bool hasPreview() const { return hasPreview_; }
@@ -63,18 +68,18 @@ private slots:
 
 private:
     void setupAudio();
-    void convertSamplesToBytes();
-    void applyVolume(QByteArray& buffer);
+    void setPlaybackEdits(const EditList& edits,
+                          std::shared_ptr<const RenderProgress> progress = nullptr);
+    [[nodiscard]] qint64 bytesPerSecond() const;
 
-    std::vector<float> originalSamples_;
-    std::vector<float> previewSamples_;
+    EditList originalEdits_;
+    SampleBuffer previewSamples_;
     bool hasPreview_;
 
     std::shared_ptr<AudioClip> audioClip_;
     
     QAudioSink* audioSink_;
-    QBuffer* audioBuffer_;
-    QByteArray audioData_;
+    SampleStreamDevice* stream_;
     QTimer* positionTimer_;
     
     PlaybackState state_;
@@ -6,17 +6,19 @@
 #include "CaptionPanel.h"
 #include "CaptionParser.h"
 #include "../Core/AudioClip.h"
-#include "../Core/EffectFactory.h"
 #include "../Core/Commands/CommandHistory.h"
 #include "../Core/Logging/CompositeLogger.h"
 #include "../Core/Logging/ConsoleLogger.h"
 #include "../Core/Logging/FileLogger.h"
-#include "../Core/EffectFactory.h"
-#include "../Core/Effects/Reverb.h"
+#include "../Core/EffectChainRenderer.h"
+#include "../Core/ExportPipeline.h"
+#include "../Core/Effects/BuiltinEffects.h"
 #include "../Core/Effects/Speed.h"
-#include "../Core/Effects/Volume.h"
 #include "../Core/Commands/ApplyEffect.h"
 #include "../Core/Commands/EffectStateCommand.h"
+#include "../Core/Services/AudioLoader.h"
+#include "../Core/Services/PcmCache.h"
+#include "../Core/Services/PeakCache.h"
 #include <QApplication>
 #include <QScreen>
 #include <QDragEnterEvent>
@@ -25,6 +27,7 @@
 #include <QShortcut>
 #include <QKeySequence>
 #include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
@@ -40,7 +43,11 @@ MainWindow::MainWindow(QWidget* parent)
     , previewDebounceTimer_(nullptr)
     , previewWatcher_(nullptr)
     , previewComputationQueued_(false)
-    , discardPreviewResult_(false)
+    , loadWatcher_(nullptr)
+    , loadProgressQueued_(false)
+    , exportWatcher_(nullptr)
+    , exportIsSave_(false)
+    , exportProgressQueued_(false)
     , hasUnsavedChanges_(false)
     , isPreviewMode_(false)
 {
@@ -57,15 +64,13 @@ MainWindow::MainWindow(QWidget* parent)
     
     logger_->log("Application starting...");
     
-    EffectFactory::registerEffect("Reverb", [](std::shared_ptr<ILogger> log) {
-        return std::make_shared<Reverb>(log);
-    });
-    EffectFactory::registerEffect("Speed", [](std::shared_ptr<ILogger> log) {
-        return std::make_shared<SpeedChangeEffect>(1.0f, log);
-    });
-    EffectFactory::registerEffect("Volume", [](std::shared_ptr<ILogger> log) {
-        return std::make_shared<VolumeEffect>(1.0f, log);
-    });
+    previewRenderer_ = std::make_shared<EffectChainRenderer>(logger_);
+    peakCache_ = std::make_shared<PeakCache>(logger_);
+    if (const uint64_t pcmCapacity = PcmCache::configuredCapacity(); pcmCapacity > 0) {
+        pcmCache_ = std::make_shared<PcmCache>(logger_, pcmCapacity);
+    }
+    
+    registerBuiltinEffects();
     
     audioEngine_ = new AudioEngine(this);
     commandHistory_ = new CommandHistory(logger_);
@@ -76,9 +81,17 @@ MainWindow::MainWindow(QWidget* parent)
     previewDebounceTimer_->setInterval(150);
     connect(previewDebounceTimer_, &QTimer::timeout, this, &MainWindow::onPreviewTimerTimeout);
 
-    previewWatcher_ = new QFutureWatcher<std::vector<float>>(this);
-    connect(previewWatcher_, &QFutureWatcher<std::vector<float>>::finished,
+    previewWatcher_ = new QFutureWatcher<PreviewResult>(this);
+    connect(previewWatcher_, &QFutureWatcher<PreviewResult>::finished,
             this, &MainWindow::onPreviewComputationFinished);
+
+    loadWatcher_ = new QFutureWatcher<bool>(this);
+    connect(loadWatcher_, &QFutureWatcher<bool>::finished,
+            this, &MainWindow::onLoadFinished);
+
+    exportWatcher_ = new QFutureWatcher<bool>(this);
+    connect(exportWatcher_, &QFutureWatcher<bool>::finished,
+            this, &MainWindow::onExportFinished);
     
     setupUI();
     setupMenuBar();
@@ -108,7 +121,14 @@ MainWindow::MainWindow(QWidget* parent)
 
 MainWindow::~MainWindow() {
     logger_->log("Application closing...");
+    cancelPendingExport();
+    cancelPendingLoad();
     cancelPendingPreview();
+    if (previewWatcher_) {
+        previewWatcher_->waitForFinished();
+    }
+    // Leaves no half-written cache entry behind.
+    pcmCacheStore_.waitForFinished();
     delete commandHistory_;
     delete captionParser_;
 }
@@ -117,6 +137,9 @@ void MainWindow::setupShortcuts() {
     QShortcut* playPauseShortcut = new QShortcut(QKeySequence(Qt::Key_Space), this);
     playPauseShortcut->setContext(Qt::ApplicationShortcut);
     connect(playPauseShortcut, &QShortcut::activated, this, &MainWindow::onTogglePlayPause);
+
+    QShortcut* cancelTaskShortcut = new QShortcut(QKeySequence(Qt::Key_Escape), this);
+    connect(cancelTaskShortcut, &QShortcut::activated, this, &MainWindow::onCancelBackgroundTask);
 }
 
 void MainWindow::onTogglePlayPause() {
@@ -371,11 +394,12 @@ void MainWindow::applyTheme() {
 void MainWindow::onNewProject() {
     if (!confirmUnsavedChanges()) return;
 
+    cancelPendingLoad();
     cancelPendingPreview();
     audioEngine_->stop();
     
     audioClip_.reset();
-    originalSamples_.clear();
+    previewRenderer_->clear();
     audioEngine_->setAudioClip(nullptr);
     waveformWidget_->clear();
     effectsPanel_->clearEffects();
@@ -413,31 +437,107 @@ void MainWindow::loadAudioFile(const QString& filePath) {
     
     logger_->log("Loading audio file: " + filePath.toStdString());
     
+    cancelPendingLoad();
     cancelPendingPreview();
     audioEngine_->stop();
     
+    auto loader = std::make_shared<AudioLoader>(filePath.toStdString(), logger_);
+    loader->setPeakCache(peakCache_);
+    loader->setPcmCache(pcmCache_);
+    if (!loader->open()) {
+        QMessageBox::critical(this, "Error", 
+            "Failed to load audio file:\n" + filePath);
+        statusBar()->showMessage("Failed to load file", 3000);
+        return;
+    }
+    
+    // The old clip goes now; the new one is installed when decoding finishes.
+    // Meanwhile the waveform shows cached peaks, or fills in block by block.
+    audioClip_.reset();
+    previewRenderer_->clear();
+    audioEngine_->setAudioClip(nullptr);
+    effectsPanel_->clearEffects();
+    captionPanel_->clearCaptions();
+    commandHistory_->clear();
+    
+    currentFilePath_.clear();
+    hasUnsavedChanges_ = false;
+    
+    updateUIState();
+    updateWindowTitle();
+    
+    waveformWidget_->setLoadingPyramid(loader->previewPyramid(), loader->getSampleRate(),
+                                       loader->getChannels(),
+                                       static_cast<qint64>(loader->totalFrames()));
     statusBar()->showMessage("Loading " + filePath + "...");
-    QApplication::processEvents();
     
-    audioClip_ = std::make_shared<AudioClip>(filePath.toStdString(), logger_);
+    loader_ = loader;
+    loadCancel_ = CancellationToken();
+    loadProgressQueued_ = false;
+    
+    // At most one progress update waits in the event queue; blocks decoded
+    // meanwhile are picked up by the next one.
+    auto progress = [this, token = loadCancel_](size_t framesLoaded, size_t totalFrames) {
+        if (token.isCancelled() || loadProgressQueued_.exchange(true)) return;
+        
+        QMetaObject::invokeMethod(this, [this, token, framesLoaded, totalFrames]() {
+            loadProgressQueued_ = false;
+            if (token.isCancelled()) return;
+            onLoadProgress(framesLoaded, totalFrames);
+        }, Qt::QueuedConnection);
+    };
+    
+    auto future = QtConcurrent::run([loader, token = loadCancel_, progress]() {
+        return loader->run(token, progress);
+    });
+    loadWatcher_->setFuture(future);
+}
+
+void MainWindow::onLoadProgress(size_t framesLoaded, size_t totalFrames) {
+    if (!loader_) return;
+    
+    waveformWidget_->updateLoadingProgress(static_cast<qint64>(totalFrames));
+    
+    const int percent = totalFrames > 0 
+        ? static_cast<int>(std::min<size_t>(100, framesLoaded * 100 / totalFrames)) 
+        : 0;
+    const QString fileName = QFileInfo(QString::fromStdString(loader_->getFilePath())).fileName();
+    statusBar()->showMessage(QString("Loading %1... %2% (Esc to cancel)").arg(fileName).arg(percent));
+}
+
+void MainWindow::onLoadFinished() {
+    // A finished signal from a load that was already waited for and replaced.
+    if (!loader_ || !loadWatcher_->isFinished()) return;
+    
+    std::shared_ptr<AudioLoader> loader = std::move(loader_);
+    
+    if (loadCancel_.isCancelled()) return;
     
-    if (!audioClip_->load()) {
+    const QString filePath = QString::fromStdString(loader->getFilePath());
+    
+    if (!loadWatcher_->result()) {
+        waveformWidget_->clear();
         QMessageBox::critical(this, "Error", 
             "Failed to load audio file:\n" + filePath);
-        audioClip_.reset();
         statusBar()->showMessage("Failed to load file", 3000);
         return;
     }
     
-    originalSamples_ = audioClip_->getSamples();
+    audioClip_ = loader->takeClip();
     
-    audioEngine_->setAudioClip(audioClip_);
+    // The clip is usable now; its decoded PCM is cached in the background.
+    // Stores queue behind each other, so waiting on the latest covers them all.
+    if (loader->hasPcmCacheEntryDue()) {
+        pcmCacheStore_ = QtConcurrent::run([loader, previous = pcmCacheStore_]() mutable {
+            previous.waitForFinished();
+            loader->storeInPcmCache();
+        });
+    }
     
-    waveformWidget_->setSamples(audioClip_->getSamples(), 44100, 2);
+    audioEngine_->setAudioClip(audioClip_);
     
-    effectsPanel_->clearEffects();
-    captionPanel_->clearCaptions();
-    commandHistory_->clear();
+    waveformWidget_->setSamples(audioClip_->getSamples(), loader->getSampleRate(),
+                                loader->getChannels(), loader->pyramid());
     
     currentFilePath_ = filePath;
     hasUnsavedChanges_ = false;
@@ -449,33 +549,27 @@ void MainWindow::loadAudioFile(const QString& filePath) {
     statusBar()->showMessage("Loaded: " + filePath, 5000);
 }
 
-std::vector<float> MainWindow::getSamplesToSave() {
-    auto effects = effectsPanel_->getEffectsForExport();
-    
-    if (effects.empty()) {
-        if (logger_) {
-            logger_->log("Saving original samples (no effects)");
-        }
-        return originalSamples_;
+void MainWindow::onCancelBackgroundTask() {
+    if (loader_) {
+        cancelPendingLoad();
+        waveformWidget_->clear();
+        statusBar()->showMessage("Loading cancelled", 3000);
     }
     
-    std::vector<float> result = originalSamples_;
-    
-    if (logger_) {
-        logger_->log("Applying " + std::to_string(effects.size()) + " effects for save");
+    // The finished signal reports the cancellation.
+    if (!exportPath_.isEmpty()) {
+        exportCancel_.cancel();
     }
-    
-    for (const auto& effect : effects) {
-        if (!effect) continue;
-        
-        if (auto* reverb = dynamic_cast<Reverb*>(effect.get())) {
-            reverb->reset();
-        }
-        
-        effect->apply(result);
-    }
-    
-    return result;
+}
+
+void MainWindow::cancelPendingLoad() {
+    if (!loader_) return;
+    
+    // The worker checks the token between blocks, so this waits for at most
+    // one block; afterwards no stale load can still post to the window.
+    loadCancel_.cancel();
+    loadWatcher_->waitForFinished();
+    loader_.reset();
 }
 
 void MainWindow::onSaveAudio() {
@@ -497,36 +591,7 @@ void MainWindow::onSaveAudio() {
 
     if (savePath.isEmpty()) return;
     
-    statusBar()->showMessage("Saving...");
-    QApplication::processEvents();
-    
-    std::vector<float> samplesToSave = getSamplesToSave();
-    
-    if (logger_) {
-        float maxSample = 0.0f;
-        for (const float s : samplesToSave) {
-            maxSample = std::max(maxSample, std::abs(s));
-        }
-        logger_->log("Saving " + std::to_string(samplesToSave.size()) + 
-                     " samples, peak: " + std::to_string(maxSample));
-    }
-    
-    std::vector<float> backup = audioClip_->getSamples();
-    
-    audioClip_->setSamples(std::move(samplesToSave));
-    
-    bool success = audioClip_->save(savePath.toStdString());
-    
-    audioClip_->setSamples(std::move(backup));
-    
-    if (success) {
-        hasUnsavedChanges_ = false;
-        updateWindowTitle();
-        statusBar()->showMessage("Saved: " + savePath, 5000);
-    } else {
-        QMessageBox::critical(this, "Error", "Failed to save audio file.");
-        statusBar()->showMessage("Save failed", 3000);
-    }
+    startExport(savePath, true);
 }
 
 void MainWindow::onExportAudio() {
@@ -538,20 +603,82 @@ void MainWindow::onExportAudio() {
 
     if (filePath.isEmpty()) return;
     
-    statusBar()->showMessage("Exporting...");
-    QApplication::processEvents();
+    startExport(filePath, false);
+}
+
+void MainWindow::startExport(const QString& filePath, bool isSave) {
+    if (!audioClip_ || !exportPath_.isEmpty()) return;
     
-    std::vector<float> samplesToSave = getSamplesToSave();
+    exportPath_ = filePath;
+    exportIsSave_ = isSave;
+    exportCancel_ = CancellationToken();
+    exportProgressQueued_ = false;
     
-    std::vector<float> backup = audioClip_->getSamples();
+    updateUIState();
+    statusBar()->showMessage((isSave ? "Saving " : "Exporting ") + filePath + "...");
     
-    audioClip_->setSamples(std::move(samplesToSave));
+    // The pieces are shared copy-on-write, so the clip stays untouched and
+    // editable while the export renders from its own EditList.
+    EditList source = audioClip_->getEditList();
+    auto effects = effectsPanel_->getEffectsForExport();
+    const int sampleRate = audioClip_->getSampleRate();
     
-    bool success = audioClip_->save(filePath.toStdString());
+    auto progress = [this, token = exportCancel_](size_t framesWritten, size_t totalFrames) {
+        if (token.isCancelled() || exportProgressQueued_.exchange(true)) return;
+        
+        QMetaObject::invokeMethod(this, [this, token, framesWritten, totalFrames]() {
+            exportProgressQueued_ = false;
+            if (token.isCancelled()) return;
+            onExportProgress(framesWritten, totalFrames);
+        }, Qt::QueuedConnection);
+    };
+    
+    auto future = QtConcurrent::run([logger = logger_, source = std::move(source),
+                                     effects = std::move(effects), sampleRate,
+                                     path = filePath.toStdString(), token = exportCancel_,
+                                     progress]() {
+        ExportPipeline pipeline(logger);
+        return pipeline.run(source, sampleRate, effects, path, token, progress);
+    });
+    exportWatcher_->setFuture(future);
+}
+
+void MainWindow::onExportProgress(size_t framesWritten, size_t totalFrames) {
+    if (exportPath_.isEmpty()) return;
+    
+    const int percent = totalFrames > 0 
+        ? static_cast<int>(std::min<size_t>(100, framesWritten * 100 / totalFrames)) 
+        : 0;
+    statusBar()->showMessage(QString("%1 %2... %3% (Esc to cancel)")
+        .arg(exportIsSave_ ? "Saving" : "Exporting")
+        .arg(QFileInfo(exportPath_).fileName())
+        .arg(percent));
+}
+
+void MainWindow::onExportFinished() {
+    if (exportPath_.isEmpty()) return;
     
-    audioClip_->setSamples(std::move(backup));
+    const QString filePath = exportPath_;
+    exportPath_.clear();
+    updateUIState();
     
-    if (success) {
+    if (exportCancel_.isCancelled()) {
+        statusBar()->showMessage(exportIsSave_ ? "Save cancelled" : "Export cancelled", 3000);
+        return;
+    }
+    
+    const bool success = exportWatcher_->result();
+    
+    if (exportIsSave_) {
+        if (success) {
+            hasUnsavedChanges_ = false;
+            updateWindowTitle();
+            statusBar()->showMessage("Saved: " + filePath, 5000);
+        } else {
+            QMessageBox::critical(this, "Error", "Failed to save audio file.");
+            statusBar()->showMessage("Save failed", 3000);
+        }
+    } else if (success) {
         statusBar()->showMessage("Exported: " + filePath, 5000);
         QMessageBox::information(this, "Export Complete",
             "Audio exported successfully to:\n" + filePath);
@@ -561,6 +688,14 @@ void MainWindow::onExportAudio() {
     }
 }
 
+void MainWindow::cancelPendingExport() {
+    if (exportPath_.isEmpty()) return;
+    
+    // The pipeline removes the partial file once it sees the token.
+    exportCancel_.cancel();
+    exportWatcher_->waitForFinished();
+}
+
 void MainWindow::onExit() {
     close();
 }
@@ -574,8 +709,8 @@ void MainWindow::onUndo() {
     commandHistory_->undo();
     
     if (audioClip_) {
-        audioEngine_->setAudioClip(audioClip_);
-        waveformWidget_->setSamples(audioClip_->getSamples(), 44100, 2);
+        audioEngine_->setOriginalEdits(audioClip_->getEditList());
+        waveformWidget_->swapSamples(audioClip_->getSamples());
     }
     
     isPreviewMode_ = false;
@@ -595,8 +730,8 @@ void MainWindow::onRedo() {
     commandHistory_->redo();
     
     if (audioClip_) {
-        audioEngine_->setAudioClip(audioClip_);
-        waveformWidget_->setSamples(audioClip_->getSamples(), 44100, 2);
+        audioEngine_->setOriginalEdits(audioClip_->getEditList());
+        waveformWidget_->swapSamples(audioClip_->getSamples());
     }
     
     isPreviewMode_ = false;
@@ -660,9 +795,10 @@ void MainWindow::onAudioLoaded() {
 
 void MainWindow::updateUIState() {
     bool hasAudio = (audioClip_ != nullptr);
+    bool canExport = hasAudio && exportPath_.isEmpty();
     
-    saveAction_->setEnabled(hasAudio);
-    exportAction_->setEnabled(hasAudio);
+    saveAction_->setEnabled(canExport);
+    exportAction_->setEnabled(canExport);
     undoAction_->setEnabled(commandHistory_->canUndo());
     redoAction_->setEnabled(commandHistory_->canRedo());
     effectsPanel_->setEnabled(hasAudio);
@@ -693,6 +829,8 @@ bool MainWindow::confirmUnsavedChanges() {
 
 void MainWindow::closeEvent(QCloseEvent* event) {
     if (confirmUnsavedChanges()) {
+        cancelPendingExport();
+        cancelPendingLoad();
         cancelPendingPreview();
         audioEngine_->stop();
         event->accept();
@@ -767,38 +905,52 @@ void MainWindow::startPreviewComputation(const std::vector<std::shared_ptr<IEffe
     if (effects.empty()) {
         cancelPendingPreview();
         audioEngine_->revertToOriginal();
-        waveformWidget_->setSamples(audioClip_->getSamples(), 44100, 2);
+        waveformWidget_->setSamples(audioClip_->getSamples(), audioClip_->getSampleRate(),
+                                    audioClip_->getChannels());
         isPreviewMode_ = false;
         statusBar()->showMessage("Original audio", 1500);
         return;
     }
 
     if (previewWatcher_->isRunning()) {
+        previewCancel_.cancel();
         queuedEffects_ = effects;
         previewComputationQueued_ = true;
         return;
     }
 
-    discardPreviewResult_.store(false);
+    previewCancel_ = CancellationToken();
     statusBar()->showMessage("Rendering preview...");
 
-    auto baseSamples = audioClip_->getSamples();
+    SampleBuffer baseSamples = audioClip_->getSamples();
+    const int channels = audioClip_->getChannels();
     std::vector<std::shared_ptr<IEffect>> effectCopies = effects;
 
-    auto future = QtConcurrent::run([baseSamples = std::move(baseSamples), effectCopies]() mutable {
-        auto processed = baseSamples;
-        
-        for (const auto& effect : effectCopies) {
-            if (!effect) continue;
-
-            if (auto* reverb = dynamic_cast<Reverb*>(effect.get())) {
-                reverb->reset();
-            }
+    // Render outward from the playhead, mapped onto the source by its share of the duration.
+    const qint64 durationMs = audioEngine_->getDurationMs();
+    const size_t sourceFrames = baseSamples.size() / static_cast<size_t>(std::max(channels, 1));
+    const size_t playheadFrame = durationMs > 0
+        ? static_cast<size_t>(static_cast<double>(audioEngine_->getPositionMs()) / durationMs * sourceFrames)
+        : 0;
 
-            effect->apply(processed);
-        }
+    auto publish = [this, token = previewCancel_](const SampleBuffer& output,
+                                                  std::shared_ptr<const RenderProgress> progress) {
+        QMetaObject::invokeMethod(this, [this, token, output, progress]() {
+            if (token.isCancelled()) return;
+            audioEngine_->previewWithSamples(output, progress);
+            isPreviewMode_ = true;
+        }, Qt::QueuedConnection);
+    };
 
-        return processed;
+    auto future = QtConcurrent::run([renderer = previewRenderer_, baseSamples = std::move(baseSamples),
+                                     channels, effectCopies, playheadFrame,
+                                     token = previewCancel_, publish]() -> PreviewResult {
+        SampleBuffer output = renderer->renderProgressive(baseSamples, channels, effectCopies,
+                                                          playheadFrame, token, publish);
+        if (output.empty() || token.isCancelled()) return {};
+        
+        auto pyramid = std::make_shared<const PeakPyramid>(output, channels);
+        return {std::move(output), std::move(pyramid)};
     });
     previewWatcher_->setFuture(future);
 }
@@ -806,12 +958,11 @@ void MainWindow::startPreviewComputation(const std::vector<std::shared_ptr<IEffe
 void MainWindow::onPreviewComputationFinished() {
     if (!previewWatcher_) return;
 
-    if (discardPreviewResult_.load()) {
-        discardPreviewResult_.store(false);
-    } else {
-        std::vector<float> processed = previewWatcher_->result();
-        audioEngine_->previewWithSamples(processed);
-        waveformWidget_->setSamples(processed, 44100, 2);
+    if (!previewCancel_.isCancelled()) {
+        const PreviewResult preview = previewWatcher_->result();
+        audioEngine_->previewWithSamples(preview.samples);
+        waveformWidget_->setPreviewSamples(preview.samples, audioClip_->getSampleRate(),
+                                           audioClip_->getChannels(), preview.pyramid);
         isPreviewMode_ = true;
         statusBar()->showMessage("Preview ready", 1000);
     }
@@ -829,10 +980,9 @@ void MainWindow::onPreviewComputationFinished() {
 void MainWindow::cancelPendingPreview() {
     if (!previewWatcher_) return;
 
-    if (previewWatcher_->isRunning()) {
-        discardPreviewResult_.store(true);
-        previewWatcher_->waitForFinished();
-    }
+    // The running render sees the token between blocks and ends on its own;
+    // onPreviewComputationFinished() then drops its result.
+    previewCancel_.cancel();
 
     previewComputationQueued_ = false;
     queuedEffects_.clear();
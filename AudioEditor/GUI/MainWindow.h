@@ -15,10 +15,13 @@
 #include <QCloseEvent>
 #include <QTimer>
 #include <QFileInfo>
+#include <QFuture>
 #include <QFutureWatcher>
-#include <memory>
 #include <atomic>
+#include <memory>
 #include "EffectsPanel.h"
+#include "../Core/SampleBuffer.h"
+#include "../Core/CancellationToken.h"
 
 class AudioEngine;
 class AudioClip;
@@ -29,6 +32,11 @@ class CaptionParser;
 class ILogger;
 class CommandHistory;
 class IEffect;
+class EffectChainRenderer;
+class AudioLoader;
+class PcmCache;
+class PeakCache;
+class PeakPyramid;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -69,6 +77,9 @@ private slots:
     void onApplyEffects();
     void onPreviewTimerTimeout();
     void onPreviewComputationFinished();
+    void onLoadFinished();
+    void onExportFinished();
+    void onCancelBackgroundTask();
     void onEffectStateChanged(const EffectsPanelState& oldState, const EffectsPanelState& newState);
 
 private:
@@ -85,15 +96,17 @@ private:
     void updatePreview();
     void startPreviewComputation(const std::vector<std::shared_ptr<IEffect>>& effects);
     void cancelPendingPreview();
-    [[nodiscard]] std::vector<float> getSamplesToSave();
+    void cancelPendingLoad();
+    void onLoadProgress(size_t framesLoaded, size_t totalFrames);
+    void startExport(const QString& filePath, bool isSave);
+    void cancelPendingExport();
+    void onExportProgress(size_t framesWritten, size_t totalFrames);
 
     std::shared_ptr<ILogger> logger_;
     std::shared_ptr<AudioClip> audioClip_;
     AudioEngine* audioEngine_;
     CommandHistory* commandHistory_;
     CaptionParser* captionParser_;
-    
-    std::vector<float> originalSamples_;
 
     QWidget* centralWidget_;
     TransportBar* transportBar_;
@@ -117,11 +130,32 @@ private:
     QAction* exportCaptionsAction_;
     QAction* aboutAction_;
     
+    // A finished preview and its waveform pyramid, both built off the GUI thread.
+    struct PreviewResult {
+        SampleBuffer samples;
+        std::shared_ptr<const PeakPyramid> pyramid;
+    };
+
     QTimer* previewDebounceTimer_;
-    QFutureWatcher<std::vector<float>>* previewWatcher_;
+    QFutureWatcher<PreviewResult>* previewWatcher_;
     bool previewComputationQueued_;
     std::vector<std::shared_ptr<IEffect>> queuedEffects_;
-    std::atomic<bool> discardPreviewResult_;
+    std::shared_ptr<EffectChainRenderer> previewRenderer_;
+    CancellationToken previewCancel_;
+    
+    QFutureWatcher<bool>* loadWatcher_;
+    std::shared_ptr<AudioLoader> loader_;
+    std::shared_ptr<const PeakCache> peakCache_;
+    std::shared_ptr<PcmCache> pcmCache_;
+    QFuture<void> pcmCacheStore_;
+    CancellationToken loadCancel_;
+    std::atomic<bool> loadProgressQueued_;
+    
+    QFutureWatcher<bool>* exportWatcher_;
+    CancellationToken exportCancel_;
+    QString exportPath_;
+    bool exportIsSave_;
+    std::atomic<bool> exportProgressQueued_;
     
     QString currentFilePath_;
     bool hasUnsavedChanges_;
@@ -0,0 +1,101 @@
+#include "SampleStreamDevice.h"
+#include "../Core/Constants.h"
+#include "../Core/Dsp/SampleKernels.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+SampleStreamDevice::SampleStreamDevice(QObject* parent)
+    : QIODevice(parent)
+{
+}
+
+void SampleStreamDevice::setSamples(const SampleBuffer& samples, int channels,
+                                    std::shared_ptr<const RenderProgress> progress) {
+    setEdits(EditList(samples, channels), std::move(progress));
+}
+
+void SampleStreamDevice::setEdits(const EditList& edits,
+                                  std::shared_ptr<const RenderProgress> progress) {
+    {
+        QMutexLocker locker(&mutex_);
+        edits_ = edits;
+        progress_ = std::move(progress);
+    }
+    
+    if (isOpen() && pos() > size()) {
+        seek(size());
+    }
+}
+
+SampleBuffer SampleStreamDevice::getSamples() const {
+    QMutexLocker locker(&mutex_);
+    return edits_.render();
+}
+
+qint64 SampleStreamDevice::size() const {
+    QMutexLocker locker(&mutex_);
+    return static_cast<qint64>(edits_.frames()) * edits_.channels() * kBytesPerSample;
+}
+
+qint64 SampleStreamDevice::readData(char* data, qint64 maxSize) {
+    QMutexLocker locker(&mutex_);
+    
+    const qint64 firstSample = pos() / kBytesPerSample;
+    const qint64 totalSamples = static_cast<qint64>(edits_.frames()) * edits_.channels();
+    if (firstSample >= totalSamples) {
+        return 0;
+    }
+    
+    const qint64 count = std::min(maxSize / kBytesPerSample, totalSamples - firstSample);
+    qint16* dest = reinterpret_cast<qint16*>(data);
+    
+    const auto channels = static_cast<qint64>(edits_.channels());
+    const qint64 granuleSamples = static_cast<qint64>(audio::render::kProgressGranuleFrames) * channels;
+    
+    qint64 i = 0;
+    while (i < count) {
+        const qint64 sampleIndex = firstSample + i;
+        const qint64 chunkEnd = progress_
+            ? std::min(count, (sampleIndex / granuleSamples + 1) * granuleSamples - firstSample)
+            : count;
+        
+        if (progress_ && !progress_->isRendered(static_cast<size_t>(sampleIndex / channels))) {
+            std::fill(dest + i, dest + chunkEnd, qint16(0));
+            i = chunkEnd;
+            continue;
+        }
+        
+        convert(sampleIndex, dest + i, chunkEnd - i);
+        i = chunkEnd;
+    }
+    
+    return count * kBytesPerSample;
+}
+
+void SampleStreamDevice::convert(qint64 firstSample, qint16* dest, qint64 count) const {
+    const auto channels = static_cast<qint64>(edits_.channels());
+    const qint64 firstFrame = firstSample / channels;
+    const qint64 lastFrame = (firstSample + count + channels - 1) / channels;
+    // Samples of the first frame before firstSample (reads need not be frame aligned).
+    qint64 skip = firstSample - firstFrame * channels;
+    
+    edits_.visit(static_cast<size_t>(firstFrame), static_cast<size_t>(lastFrame - firstFrame),
+                 [&](const float* span, size_t frames) {
+        const qint64 available = static_cast<qint64>(frames) * channels - skip;
+        const qint64 n = std::min(available, count);
+        if (span) {
+            dsp::floatToInt16(span + skip, dest, static_cast<size_t>(n));
+        } else {
+            std::fill(dest, dest + n, qint16(0));
+        }
+        dest += n;
+        count -= n;
+        skip = 0;
+    });
+}
+
+qint64 SampleStreamDevice::writeData(const char* data, qint64 maxSize) {
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
@@ -0,0 +1,49 @@
+#ifndef SAMPLE_STREAM_DEVICE_H
+#define SAMPLE_STREAM_DEVICE_H
+
+#include <QIODevice>
+#include <QMutex>
+#include "../Core/EditList.h"
+#include "../Core/SampleBuffer.h"
+#include "../Core/RenderProgress.h"
+#include <memory>
+
+// Pull-mode playback source: converts float samples to Int16 only when the
+// audio sink asks for them, so swapping the buffer is a handle exchange. An
+// edited clip plays straight from its EditList pieces.
+class SampleStreamDevice : public QIODevice {
+    Q_OBJECT
+
+public:
+    explicit SampleStreamDevice(QObject* parent = nullptr);
+    ~SampleStreamDevice() override = default;
+
+    SampleStreamDevice(const SampleStreamDevice&) = delete;
+    SampleStreamDevice& operator=(const SampleStreamDevice&) = delete;
+
+    // With progress set, frames it has not marked rendered yet play as silence.
+    void setSamples(const SampleBuffer& samples, int channels,
+                    std::shared_ptr<const RenderProgress> progress = nullptr);
+    void setEdits(const EditList& edits,
+                  std::shared_ptr<const RenderProgress> progress = nullptr);
+    [[nodiscard]] SampleBuffer getSamples() const;
+
+    [[nodiscard]] bool isSequential() const override { return false; }
+    [[nodiscard]] qint64 size() const override;
+
+    static constexpr qint64 kBytesPerSample = sizeof(qint16);
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    // Converts count samples from firstSample on, zero-filling silence pieces.
+    void convert(qint64 firstSample, qint16* dest, qint64 count) const;
+
+    mutable QMutex mutex_;
+    EditList edits_;
+    std::shared_ptr<const RenderProgress> progress_;
+};
+
+#endif
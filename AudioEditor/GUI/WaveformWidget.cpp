@@ -1,4 +1,5 @@
 #include "WaveformWidget.h"
+#include "../Core/Constants.h"
 #include <QPainter>
 #include <QPaintEvent>
 #include <QMouseEvent>
@@ -13,6 +14,8 @@ WaveformWidget::WaveformWidget(QWidget* parent)
     , channels_(2)
     , durationMs_(0)
     , cacheValid_(false)
+    , showingLoad_(false)
+    , showingPreview_(false)
     , displayScale_(1.0f)
     , zoom_(1.0f)
     , scrollOffsetMs_(0)
@@ -22,6 +25,7 @@ WaveformWidget::WaveformWidget(QWidget* parent)
     , backgroundColor_(QColor(0x1e, 0x1e, 0x1e))
     , waveformColor_(QColor(0x4c, 0xaf, 0x50))
     , waveformPeakColor_(QColor(0x81, 0xc7, 0x84))
+    , waveformRmsColor_(QColor(0x38, 0x8e, 0x3c))
     , playheadColor_(QColor(0x00, 0xbc, 0xd4))
     , centerLineColor_(QColor(0x3d, 0x3d, 0x3d))
 {
@@ -35,21 +39,46 @@ WaveformWidget::WaveformWidget(QWidget* parent)
     setPalette(pal);
 }
 
-void WaveformWidget::setSamples(const std::vector<float>& samples, 
-                                 int sampleRate, int channels) {
+void WaveformWidget::setSamples(const SampleBuffer& samples, 
+                                 int sampleRate, int channels,
+                                 std::shared_ptr<const PeakPyramid> pyramid) {
+    // Finishing a progressive load keeps whatever zoom the user picked meanwhile.
+    const bool keepView = showingLoad_;
+    showingLoad_ = false;
+    
+    rememberPyramid();
+    showingPreview_ = false;
     samples_ = samples;
     sampleRate_ = sampleRate;
     channels_ = channels;
     
     if (sampleRate_ > 0 && channels_ > 0 && !samples_.empty()) {
-        qint64 totalFrames = samples_.size() / channels_;
+        const qint64 totalFrames = samples_.size() / channels_;
         durationMs_ = (totalFrames * 1000) / sampleRate_;
+        
+        if (!pyramid) {
+            pyramid = takeCachedPyramid(samples_);
+        }
+        
+        if (pyramid && pyramid->channels() == channels_ &&
+            pyramid->frames() == static_cast<size_t>(totalFrames)) {
+            pyramid_ = std::move(pyramid);
+        } else {
+            pyramid_ = std::make_shared<PeakPyramid>(samples_, channels_);
+        }
     } else {
         durationMs_ = 0;
+        pyramid_.reset();
     }
     
-    zoom_ = 1.0f;
-    scrollOffsetMs_ = 0;
+    if (keepView) {
+        const qint64 visibleDuration = durationMs_ / zoom_;
+        scrollOffsetMs_ = std::clamp(scrollOffsetMs_, qint64(0),
+                                     std::max(qint64(0), durationMs_ - visibleDuration));
+    } else {
+        zoom_ = 1.0f;
+        scrollOffsetMs_ = 0;
+    }
     
     if (playheadPositionMs_ > durationMs_) {
         playheadPositionMs_ = 0;
@@ -61,8 +90,99 @@ void WaveformWidget::setSamples(const std::vector<float>& samples,
     update();
 }
 
+void WaveformWidget::setPreviewSamples(const SampleBuffer& samples, int sampleRate, int channels,
+                                       std::shared_ptr<const PeakPyramid> pyramid) {
+    setSamples(samples, sampleRate, channels, std::move(pyramid));
+    showingPreview_ = true;
+}
+
+void WaveformWidget::swapSamples(const SampleBuffer& samples) {
+    if (samples.id() == samples_.id() && samples.size() == samples_.size()) {
+        return;
+    }
+    
+    rememberPyramid();
+    showingPreview_ = false;
+    samples_ = samples;
+    
+    const qint64 totalFrames = channels_ > 0 ? static_cast<qint64>(samples_.size()) / channels_ : 0;
+    pyramid_ = takeCachedPyramid(samples_);
+    if (!pyramid_ && totalFrames > 0) {
+        pyramid_ = std::make_shared<PeakPyramid>(samples_, channels_);
+    }
+    
+    setDurationFrames(totalFrames);
+    
+    const qint64 visibleDuration = durationMs_ / zoom_;
+    scrollOffsetMs_ = std::clamp(scrollOffsetMs_, qint64(0),
+                                 std::max(qint64(0), durationMs_ - visibleDuration));
+    playheadPositionMs_ = std::min(playheadPositionMs_, durationMs_);
+    
+    computePeaks();
+    update();
+}
+
+void WaveformWidget::rememberPyramid() {
+    if (!pyramid_ || samples_.id() == 0 || showingPreview_) return;
+    
+    pyramid_->detachSource();
+    pyramidCache_.emplace_back(samples_.id(), pyramid_);
+    if (pyramidCache_.size() > audio::waveform::kPyramidCacheEntries) {
+        pyramidCache_.pop_front();
+    }
+}
+
+std::shared_ptr<const PeakPyramid> WaveformWidget::takeCachedPyramid(const SampleBuffer& samples) {
+    for (auto it = pyramidCache_.begin(); it != pyramidCache_.end(); ++it) {
+        if (it->first != samples.id()) continue;
+        
+        auto pyramid = std::move(it->second);
+        pyramidCache_.erase(it);
+        if (pyramid->channels() != channels_ ||
+            pyramid->frames() * static_cast<size_t>(channels_) != samples.size()) {
+            return nullptr;
+        }
+        pyramid->attachSource(samples);
+        return pyramid;
+    }
+    return nullptr;
+}
+
+void WaveformWidget::setLoadingPyramid(std::shared_ptr<const PeakPyramid> pyramid,
+                                       int sampleRate, int channels, qint64 totalFrames) {
+    samples_.clear();
+    pyramidCache_.clear();
+    pyramid_ = std::move(pyramid);
+    showingLoad_ = pyramid_ != nullptr;
+    showingPreview_ = false;
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    zoom_ = 1.0f;
+    scrollOffsetMs_ = 0;
+    playheadPositionMs_ = 0;
+    
+    setDurationFrames(totalFrames);
+    update();
+}
+
+void WaveformWidget::updateLoadingProgress(qint64 totalFrames) {
+    if (!pyramid_) return;
+    
+    setDurationFrames(totalFrames);
+    update();
+}
+
+void WaveformWidget::setDurationFrames(qint64 totalFrames) {
+    durationMs_ = sampleRate_ > 0 ? (totalFrames * 1000) / sampleRate_ : 0;
+    cacheValid_ = false;
+}
+
 void WaveformWidget::clear() {
     samples_.clear();
+    pyramid_.reset();
+    pyramidCache_.clear();
+    showingLoad_ = false;
+    showingPreview_ = false;
     peaks_.clear();
     displayScale_ = 1.0f;
     durationMs_ = 0;
@@ -118,7 +238,7 @@ qint64 WaveformWidget::getDurationMs() const {
 void WaveformWidget::computePeaks() {
     peaks_.clear();
     
-    if (samples_.empty()) {
+    if (!pyramid_) {
         return;
     }
     
@@ -135,51 +255,29 @@ void WaveformWidget::computePeaks() {
         return;
     }
     
-    peaks_.resize(widgetWidth);
-    
     qint64 visibleDuration = durationMs_ / zoom_;
     if (visibleDuration <= 0) {
         visibleDuration = durationMs_;
     }
     
-    qint64 visibleSamples = (visibleDuration * sampleRate_ * channels_) / 1000;
-    if (visibleSamples <= 0) {
+    qint64 visibleFrames = (visibleDuration * sampleRate_) / 1000;
+    if (visibleFrames <= 0) {
         return;
     }
     
-    double samplesPerPixel = static_cast<double>(visibleSamples) / widgetWidth;
-    if (samplesPerPixel <= 0) {
-        samplesPerPixel = 1.0;
-    }
+    qint64 startFrame = (scrollOffsetMs_ * sampleRate_) / 1000;
     
-    qint64 startSample = (scrollOffsetMs_ * sampleRate_ * channels_) / 1000;
+    const auto summaries = pyramid_->summarize(static_cast<size_t>(startFrame),
+                                               static_cast<size_t>(startFrame + visibleFrames),
+                                               widgetWidth);
     
+    peaks_.resize(summaries.size());
     float maxAbsValue = 0.0f;
 
-    for (int x = 0; x < widgetWidth; ++x) {
-        qint64 sampleStart = startSample + static_cast<qint64>(x * samplesPerPixel);
-        qint64 sampleEnd = startSample + static_cast<qint64>((x + 1) * samplesPerPixel);
-        
-        sampleStart = std::clamp(sampleStart, qint64(0), static_cast<qint64>(samples_.size()));
-        sampleEnd = std::clamp(sampleEnd, qint64(0), static_cast<qint64>(samples_.size()));
-        
-        float minVal = 0.0f;
-        float maxVal = 0.0f;
-        
-        if (sampleStart < sampleEnd) {
-            minVal = samples_[sampleStart];
-            maxVal = samples_[sampleStart];
-            
-            qint64 step = std::max(qint64(1), (sampleEnd - sampleStart) / 100);
-            for (qint64 i = sampleStart; i < sampleEnd; i += step) {
-                float sample = samples_[i];
-                minVal = std::min(minVal, sample);
-                maxVal = std::max(maxVal, sample);
-            }
-        }
-        
-        peaks_[x] = {minVal, maxVal};
-        maxAbsValue = std::max(maxAbsValue, std::max(std::abs(minVal), std::abs(maxVal)));
+    for (size_t x = 0; x < summaries.size(); ++x) {
+        const auto& summary = summaries[x];
+        peaks_[x] = {summary.min, summary.max, summary.rms};
+        maxAbsValue = std::max(maxAbsValue, std::max(std::abs(summary.min), std::abs(summary.max)));
     }
 
     if (maxAbsValue > 0.001f) {
@@ -235,6 +333,15 @@ void WaveformWidget::renderWaveform() {
         painter.setPen(QPen(waveformColor_, 1));
         painter.drawLine(x, minY, x, maxY);
         
+        float scaledRms = std::clamp(peak.rms * displayScale_, 0.0f, 1.0f);
+        int rmsHalfHeight = static_cast<int>(scaledRms * drawableHeight);
+        if (rmsHalfHeight > 0) {
+            int rmsTop = std::max(minY, centerY - rmsHalfHeight);
+            int rmsBottom = std::min(maxY, centerY + rmsHalfHeight);
+            painter.setPen(QPen(waveformRmsColor_, 1));
+            painter.drawLine(x, rmsTop, x, rmsBottom);
+        }
+        
         if (maxY - minY > 4) {
             painter.setPen(QPen(waveformPeakColor_, 1));
             painter.drawPoint(x, minY);
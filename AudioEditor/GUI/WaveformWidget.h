@@ -3,7 +3,13 @@
 
 #include <QWidget>
 #include <QPixmap>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
 #include <vector>
+#include "../Core/SampleBuffer.h"
+#include "../Core/Services/PeakPyramid.h"
 
 class WaveformWidget : public QWidget {
     Q_OBJECT
@@ -12,7 +18,21 @@ public:
     explicit WaveformWidget(QWidget* parent = nullptr);
     ~WaveformWidget() = default;
 
-    void setSamples(const std::vector<float>& samples, int sampleRate, int channels);
+    // Reuses pyramid when it already summarises samples (e.g. one built while loading).
+    void setSamples(const SampleBuffer& samples, int sampleRate, int channels,
+                    std::shared_ptr<const PeakPyramid> pyramid = nullptr);
+    // Shows an effect preview of the current clip. Preview pyramids are not
+    // cached, so slider tweaks never push out the clip versions undo needs.
+    void setPreviewSamples(const SampleBuffer& samples, int sampleRate, int channels,
+                           std::shared_ptr<const PeakPyramid> pyramid = nullptr);
+    // Undo/redo: shows another version of the current clip, keeping the view.
+    // Pyramids of recently shown versions are kept by buffer id, so stepping
+    // back and forth does not rescan the samples.
+    void swapSamples(const SampleBuffer& samples);
+    // Shows a pyramid a background load is still appending to.
+    void setLoadingPyramid(std::shared_ptr<const PeakPyramid> pyramid,
+                           int sampleRate, int channels, qint64 totalFrames);
+    void updateLoadingProgress(qint64 totalFrames);
     void clear();
     void setPlayheadPosition(qint64 positionMs);
     void setZoom(float zoom);
@@ -32,11 +52,16 @@ protected:
 
 private:
     void computePeaks();
+    void setDurationFrames(qint64 totalFrames);
+    void rememberPyramid();
+    [[nodiscard]] std::shared_ptr<const PeakPyramid> takeCachedPyramid(const SampleBuffer& samples);
     void renderWaveform();
     int positionToX(qint64 positionMs) const;
     qint64 xToPosition(int x) const;
 
-    std::vector<float> samples_;
+    SampleBuffer samples_;
+    std::shared_ptr<const PeakPyramid> pyramid_;
+    std::deque<std::pair<uint64_t, std::shared_ptr<const PeakPyramid>>> pyramidCache_;
     int sampleRate_;
     int channels_;
     qint64 durationMs_;
@@ -44,11 +69,14 @@ private:
     struct Peak {
         float min;
         float max;
+        float rms;
     };
     std::vector<Peak> peaks_;
 
     QPixmap waveformCache_;
     bool cacheValid_;
+    bool showingLoad_;
+    bool showingPreview_;
     float displayScale_;
 
     float zoom_;
@@ -61,6 +89,7 @@ private:
     QColor backgroundColor_;
     QColor waveformColor_;
     QColor waveformPeakColor_;
+    QColor waveformRmsColor_;
     QColor playheadColor_;
     QColor centerLineColor_;
 };